@@ -5,7 +5,12 @@ namespace {
     constexpr const char* DEFAULT_API_URL = "http://khmergaming.436bet.com/app/log_sys.php";
     constexpr bool DEFAULT_DEBUG_MODE = false;
     constexpr qint64 DEFAULT_DUPLICATE_THRESHOLD = 500;
+    constexpr int DEFAULT_EVENT_COALESCE_WINDOW_MS = 100;
+    constexpr int DEFAULT_POLL_INTERVAL_MS = 2000;
     constexpr int DEFAULT_REFRESH_INTERVAL = 2000;
+    constexpr bool DEFAULT_HASH_ONLY_BASELINE = false;
+    constexpr int DEFAULT_BASELINE_MEMORY_BUDGET_MB = 2048;
+    constexpr int DEFAULT_BASELINE_MAX_FILE_SIZE_MB = 32;
 }
 
 AppConfig::AppConfig()
@@ -19,7 +24,12 @@ void AppConfig::load()
     m_apiUrl = m_settings.value("apiUrl", DEFAULT_API_URL).toString();
     m_debugMode = m_settings.value("debugMode", DEFAULT_DEBUG_MODE).toBool();
     m_duplicateEventThreshold = m_settings.value("duplicateEventThreshold", DEFAULT_DUPLICATE_THRESHOLD).toLongLong();
+    m_eventCoalesceWindowMs = m_settings.value("eventCoalesceWindowMs", DEFAULT_EVENT_COALESCE_WINDOW_MS).toInt();
+    m_pollIntervalMs = m_settings.value("pollIntervalMs", DEFAULT_POLL_INTERVAL_MS).toInt();
     m_autoRefreshInterval = m_settings.value("autoRefreshInterval", DEFAULT_REFRESH_INTERVAL).toInt();
+    m_hashOnlyBaseline = m_settings.value("hashOnlyBaseline", DEFAULT_HASH_ONLY_BASELINE).toBool();
+    m_baselineMemoryBudgetMb = m_settings.value("baselineMemoryBudgetMb", DEFAULT_BASELINE_MEMORY_BUDGET_MB).toInt();
+    m_baselineMaxFileSizeMb = m_settings.value("baselineMaxFileSizeMb", DEFAULT_BASELINE_MAX_FILE_SIZE_MB).toInt();
 }
 
 void AppConfig::save()
@@ -27,6 +37,11 @@ void AppConfig::save()
     m_settings.setValue("apiUrl", m_apiUrl);
     m_settings.setValue("debugMode", m_debugMode);
     m_settings.setValue("duplicateEventThreshold", m_duplicateEventThreshold);
+    m_settings.setValue("eventCoalesceWindowMs", m_eventCoalesceWindowMs);
+    m_settings.setValue("pollIntervalMs", m_pollIntervalMs);
     m_settings.setValue("autoRefreshInterval", m_autoRefreshInterval);
+    m_settings.setValue("hashOnlyBaseline", m_hashOnlyBaseline);
+    m_settings.setValue("baselineMemoryBudgetMb", m_baselineMemoryBudgetMb);
+    m_settings.setValue("baselineMaxFileSizeMb", m_baselineMaxFileSizeMb);
     m_settings.sync();
 }
\ No newline at end of file
@@ -28,13 +28,34 @@ public:
     bool isDebugMode() const { return m_debugMode; }
     void setDebugMode(bool debug) { m_debugMode = debug; save(); }
 
-    // File Watcher Settings
+    // File Watcher Settings: a path must be quiet this long before its event
+    // is reported (0 = report every event)
     qint64 duplicateEventThreshold() const { return m_duplicateEventThreshold; }
     void setDuplicateEventThreshold(qint64 ms) { m_duplicateEventThreshold = ms; save(); }
 
+    // Window over which watcher events are merged into one batch
+    int eventCoalesceWindowMs() const { return m_eventCoalesceWindowMs; }
+    void setEventCoalesceWindowMs(int ms) { m_eventCoalesceWindowMs = ms; save(); }
+
+    // Interval between scans of systems watched by polling
+    int pollIntervalMs() const { return m_pollIntervalMs; }
+    void setPollIntervalMs(int ms) { m_pollIntervalMs = ms; save(); }
+
     int autoRefreshInterval() const { return m_autoRefreshInterval; }
     void setAutoRefreshInterval(int ms) { m_autoRefreshInterval = ms; save(); }
 
+    // Baseline Settings: keep only size + hash per file instead of full content
+    bool hashOnlyBaseline() const { return m_hashOnlyBaseline; }
+    void setHashOnlyBaseline(bool enabled) { m_hashOnlyBaseline = enabled; save(); }
+
+    // Upper bound for compressed baseline content held in memory (0 = unlimited)
+    int baselineMemoryBudgetMb() const { return m_baselineMemoryBudgetMb; }
+    void setBaselineMemoryBudgetMb(int mb) { m_baselineMemoryBudgetMb = mb; save(); }
+
+    // Files larger than this are tracked by size + hash only (0 = no cap)
+    int baselineMaxFileSizeMb() const { return m_baselineMaxFileSizeMb; }
+    void setBaselineMaxFileSizeMb(int mb) { m_baselineMaxFileSizeMb = mb; save(); }
+
     // Load/Save
     void load();
     void save();
@@ -45,7 +66,12 @@ private:
     QString m_apiUrl;
     bool m_debugMode;
     qint64 m_duplicateEventThreshold;
+    int m_eventCoalesceWindowMs;
+    int m_pollIntervalMs;
     int m_autoRefreshInterval;
+    bool m_hashOnlyBaseline;
+    int m_baselineMemoryBudgetMb;
+    int m_baselineMaxFileSizeMb;
     
     QSettings m_settings;
 };
@@ -0,0 +1,435 @@
+#include "baseline_snapshot.h"
+#include "file_manifest.h"
+#include "../utils/content_hash.h"
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QRandomGenerator>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <algorithm>
+
+namespace {
+    const QString MANIFEST_FILE = QStringLiteral("manifest.bin");
+    const QString PACK_PREFIX = QStringLiteral("blobs-");
+    const QString PACK_SUFFIX = QStringLiteral(".pack");
+    // Per-blob directory written by snapshots older than the pack
+    const QString LEGACY_BLOB_DIR = QStringLiteral("blobs");
+
+    // Hash, offset and length of one index record as QDataStream writes them
+    constexpr qint64 INDEX_RECORD_BYTES = 8 + 8 + 4;
+
+    struct BlobLocation {
+        qint64 offset = 0;
+        quint32 length = 0;
+    };
+
+    struct ManifestHeader {
+        quint32 magic = 0;
+        quint32 version = 0;
+        QString root;
+        qint64 captureTimeNs = 0;
+        QString packName;
+        quint32 blobCount = 0;
+    };
+
+    inline QString hashToHex(quint64 hash)
+    {
+        return QString::number(hash, 16).rightJustified(16, QLatin1Char('0'));
+    }
+
+    inline QString manifestPath(const QString& location)
+    {
+        return location + QLatin1Char('/') + MANIFEST_FILE;
+    }
+
+    inline QString packPath(const QString& location, const QString& packName)
+    {
+        return location + QLatin1Char('/') + packName;
+    }
+
+    // Packs get a fresh name when created or compacted, so a manifest never
+    // points into a pack rewritten underneath it
+    inline QString newPackName()
+    {
+        return PACK_PREFIX + hashToHex(QRandomGenerator::global()->generate64()) + PACK_SUFFIX;
+    }
+
+    // Reads the header up to the blob index; false if it is not a manifest
+    // of the current version
+    bool readHeader(QDataStream& in, ManifestHeader* header)
+    {
+        in >> header->magic >> header->version >> header->root >> header->captureTimeNs
+           >> header->packName >> header->blobCount;
+        return in.status() == QDataStream::Ok && header->magic == SnapshotConfig::MAGIC &&
+               header->version == SnapshotConfig::VERSION && !header->packName.contains(QLatin1Char('/'));
+    }
+}
+
+/**
+ * @brief Blob pack of a snapshot and its in-memory index
+ */
+struct BaselineSnapshot::Pack {
+    QMutex mutex;
+    // File name within the snapshot location; empty until the first blob
+    QString name;
+    QHash<quint64, BlobLocation> blobs;
+    // Opened on the first append; a failed append is truncated back to end
+    QFile file;
+    qint64 end = 0;
+    bool failed = false;
+};
+
+BaselineSnapshot::BaselineSnapshot()
+    : m_pack(std::make_unique<Pack>())
+{
+}
+
+BaselineSnapshot::~BaselineSnapshot() = default;
+BaselineSnapshot::BaselineSnapshot(BaselineSnapshot&& other) noexcept = default;
+BaselineSnapshot& BaselineSnapshot::operator=(BaselineSnapshot&& other) noexcept = default;
+
+QString BaselineSnapshot::locationFor(const QString& systemName, const QString& sourceRoot)
+{
+    // The separator cannot occur in either part, so distinct pairs never collide
+    const QByteArray identity = systemName.toUtf8() + '\0' + QDir::cleanPath(sourceRoot).toUtf8();
+    return QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation)
+        + QStringLiteral("/baselines/") + hashToHex(ContentHasher::hash(identity));
+}
+
+BaselineSnapshot BaselineSnapshot::load(const QString& location, const QString& sourceRoot)
+{
+    BaselineSnapshot snapshot;
+    snapshot.m_location = location;
+    if (!snapshot.readManifest(sourceRoot)) {
+        // A missing, stale or truncated manifest is useless; fall back to a
+        // full capture into a fresh pack
+        BaselineSnapshot empty;
+        empty.m_location = location;
+        return empty;
+    }
+    return snapshot;
+}
+
+bool BaselineSnapshot::readManifest(const QString& sourceRoot)
+{
+    QFile file(manifestPath(m_location));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_6_0);
+
+    ManifestHeader header;
+    if (!readHeader(in, &header) || header.root != QDir::cleanPath(sourceRoot)) {
+        return false;
+    }
+    m_captureTimeNs = header.captureTimeNs;
+
+    qint64 packEnd = 0;
+    m_pack->blobs.reserve(header.blobCount);
+    for (quint32 i = 0; i < header.blobCount; ++i) {
+        quint64 hash = 0;
+        BlobLocation blob;
+        in >> hash >> blob.offset >> blob.length;
+        m_pack->blobs.insert(hash, blob);
+        packEnd = qMax(packEnd, blob.offset + blob.length);
+    }
+
+    quint32 count = 0;
+    in >> count;
+    if (in.status() != QDataStream::Ok) {
+        return false;
+    }
+
+    m_entries.reserve(count);
+    for (quint32 i = 0; i < count; ++i) {
+        QString relativePath;
+        SnapshotEntry entry;
+        in >> relativePath >> entry.size >> entry.mtimeNs >> entry.inode >> entry.hash;
+        if (in.status() != QDataStream::Ok) {
+            return false;
+        }
+        m_entries.insert(relativePath, entry);
+    }
+
+    // The recorded hashes stay usable without the pack; only the content
+    // has to be read again
+    if (header.blobCount > 0 && QFileInfo(packPath(m_location, header.packName)).size() < packEnd) {
+        m_pack->blobs.clear();
+    } else {
+        m_pack->name = header.packName;
+    }
+    return true;
+}
+
+bool BaselineSnapshot::save(const FileManifest& manifest,
+                            const std::vector<quint64>& hashes,
+                            const std::vector<char>& captured,
+                            qint64 captureTimeNs)
+{
+    if (!QDir().mkpath(m_location)) {
+        return false;
+    }
+
+    QMutexLocker locker(&m_pack->mutex);
+
+    // Appended blobs must be on disk before the manifest points at them
+    if (m_pack->file.isOpen()) {
+        const bool flushed = m_pack->file.flush();
+        m_pack->file.close();
+        if (!flushed) {
+            return false;
+        }
+    }
+
+    const QVector<ManifestEntry>& files = manifest.files();
+    quint32 count = 0;
+    QSet<quint64> referenced;
+    for (int i = 0; i < files.size(); ++i) {
+        if (captured[i]) {
+            ++count;
+            referenced.insert(hashes[i]);
+        }
+    }
+
+    // Unreferenced blobs drop out of the index; their bytes stay in the
+    // pack until there are enough of them to be worth a rewrite
+    qint64 liveBytes = 0;
+    for (auto it = m_pack->blobs.begin(); it != m_pack->blobs.end();) {
+        if (referenced.contains(it.key())) {
+            liveBytes += it->length;
+            ++it;
+        } else {
+            it = m_pack->blobs.erase(it);
+        }
+    }
+    const qint64 packBytes = m_pack->name.isEmpty() ? 0 : QFileInfo(packPath(m_location, m_pack->name)).size();
+    const qint64 deadBytes = packBytes - liveBytes;
+    if (deadBytes > 0 && deadBytes > packBytes * SnapshotConfig::PACK_MAX_DEAD_RATIO) {
+        // On failure the current pack is kept; it is still valid
+        compactPack(newPackName());
+    }
+
+    // QSaveFile keeps the previous manifest intact if writing fails midway
+    QSaveFile file(manifestPath(m_location));
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_6_0);
+
+    QList<quint64> blobHashes = m_pack->blobs.keys();
+    std::sort(blobHashes.begin(), blobHashes.end());
+    out << SnapshotConfig::MAGIC << SnapshotConfig::VERSION << manifest.root() << captureTimeNs
+        << m_pack->name << quint32(blobHashes.size());
+    for (quint64 hash : blobHashes) {
+        const BlobLocation& blob = m_pack->blobs[hash];
+        out << hash << blob.offset << blob.length;
+    }
+
+    out << count;
+    for (int i = 0; i < files.size(); ++i) {
+        if (!captured[i]) {
+            continue;
+        }
+        const ManifestEntry& entry = files.at(i);
+        out << entry.relativePath << entry.size << entry.mtimeNs << entry.inode << hashes[i];
+    }
+
+    if (out.status() != QDataStream::Ok || !file.commit()) {
+        return false;
+    }
+
+    removeStalePacks();
+    return true;
+}
+
+bool BaselineSnapshot::compactPack(const QString& packName)
+{
+    QFile source(packPath(m_location, m_pack->name));
+    if (!source.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    QSaveFile target(packPath(m_location, packName));
+    if (!target.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+
+    // Copy in pack order so the old pack is read sequentially
+    QList<quint64> order = m_pack->blobs.keys();
+    std::sort(order.begin(), order.end(), [this](quint64 a, quint64 b) {
+        return m_pack->blobs[a].offset < m_pack->blobs[b].offset;
+    });
+
+    QHash<quint64, BlobLocation> moved;
+    moved.reserve(order.size());
+    qint64 offset = 0;
+    for (quint64 hash : order) {
+        const BlobLocation& blob = m_pack->blobs[hash];
+        if (!source.seek(blob.offset)) {
+            return false;
+        }
+        const QByteArray packed = source.read(blob.length);
+        if (packed.size() != qint64(blob.length) || target.write(packed) != packed.size()) {
+            return false;
+        }
+        moved.insert(hash, BlobLocation{offset, blob.length});
+        offset += blob.length;
+    }
+
+    if (!target.commit()) {
+        return false;
+    }
+    m_pack->name = packName;
+    m_pack->blobs = std::move(moved);
+    return true;
+}
+
+void BaselineSnapshot::removeStalePacks() const
+{
+    QDir dir(m_location);
+    const QStringList packs = dir.entryList({PACK_PREFIX + QLatin1Char('*') + PACK_SUFFIX}, QDir::Files);
+    for (const QString& name : packs) {
+        if (name != m_pack->name) {
+            dir.remove(name);
+        }
+    }
+    QDir(m_location + QLatin1Char('/') + LEGACY_BLOB_DIR).removeRecursively();
+}
+
+bool BaselineSnapshot::writeBlob(quint64 hash, const QByteArray& data)
+{
+    if (hasBlob(hash)) {
+        return true;
+    }
+
+    // Compress outside the lock so readers only serialize on the append
+    const QByteArray packed = qCompress(data, SnapshotConfig::BLOB_COMPRESSION_LEVEL);
+
+    QMutexLocker locker(&m_pack->mutex);
+    if (m_pack->blobs.contains(hash)) {
+        // Another reader stored the same content meanwhile
+        return true;
+    }
+
+    if (!m_pack->file.isOpen()) {
+        if (m_pack->failed || !QDir().mkpath(m_location)) {
+            return false;
+        }
+        if (m_pack->name.isEmpty()) {
+            m_pack->name = newPackName();
+        }
+        m_pack->file.setFileName(packPath(m_location, m_pack->name));
+        if (!m_pack->file.open(QIODevice::ReadWrite)) {
+            m_pack->failed = true;
+            return false;
+        }
+        // Bytes past the last indexed blob (an interrupted capture) are
+        // left in place and reclaimed by the next compaction
+        m_pack->end = m_pack->file.size();
+    }
+
+    if (!m_pack->file.seek(m_pack->end) || m_pack->file.write(packed) != packed.size()) {
+        m_pack->file.resize(m_pack->end);
+        return false;
+    }
+    m_pack->blobs.insert(hash, BlobLocation{m_pack->end, quint32(packed.size())});
+    m_pack->end += packed.size();
+    return true;
+}
+
+bool BaselineSnapshot::hasBlob(quint64 hash) const
+{
+    QMutexLocker locker(&m_pack->mutex);
+    return m_pack->blobs.contains(hash);
+}
+
+QByteArray BaselineSnapshot::readBlob(const QString& location, quint64 hash, bool* ok)
+{
+    if (ok) {
+        *ok = false;
+    }
+
+    QFile manifestFile(manifestPath(location));
+    if (!manifestFile.open(QIODevice::ReadOnly)) {
+        return QByteArray();
+    }
+
+    QDataStream in(&manifestFile);
+    in.setVersion(QDataStream::Qt_6_0);
+
+    ManifestHeader header;
+    if (!readHeader(in, &header)) {
+        return QByteArray();
+    }
+
+    // Index records are fixed-size and sorted by hash
+    const qint64 indexStart = manifestFile.pos();
+    BlobLocation blob;
+    bool found = false;
+    quint32 low = 0;
+    quint32 high = header.blobCount;
+    while (low < high && in.status() == QDataStream::Ok) {
+        const quint32 middle = low + (high - low) / 2;
+        if (!manifestFile.seek(indexStart + qint64(middle) * INDEX_RECORD_BYTES)) {
+            return QByteArray();
+        }
+        quint64 middleHash = 0;
+        in >> middleHash;
+        if (middleHash < hash) {
+            low = middle + 1;
+        } else if (middleHash > hash) {
+            high = middle;
+        } else {
+            in >> blob.offset >> blob.length;
+            found = true;
+            break;
+        }
+    }
+    if (!found || in.status() != QDataStream::Ok) {
+        return QByteArray();
+    }
+
+    QFile pack(packPath(location, header.packName));
+    if (!pack.open(QIODevice::ReadOnly) || !pack.seek(blob.offset)) {
+        return QByteArray();
+    }
+
+    const QByteArray data = qUncompress(pack.read(blob.length));
+    // Guard against a damaged pack or one replaced underneath the manifest
+    if (ContentHasher::hash(data) != hash) {
+        return QByteArray();
+    }
+
+    if (ok) {
+        *ok = true;
+    }
+    return data;
+}
+
+const SnapshotEntry* BaselineSnapshot::findUnchanged(const QString& relativePath, qint64 size,
+                                                     qint64 mtimeNs, quint64 inode) const
+{
+    const auto it = m_entries.constFind(relativePath);
+    if (it == m_entries.constEnd()) {
+        return nullptr;
+    }
+
+    const SnapshotEntry& entry = it.value();
+    if (entry.size != size || entry.mtimeNs != mtimeNs || entry.inode != inode) {
+        return nullptr;
+    }
+
+    // Racily clean: a write in the same timestamp tick after the file was
+    // hashed would leave size and mtime as recorded
+    if (mtimeNs >= m_captureTimeNs - SnapshotConfig::MTIME_GRANULARITY_NS) {
+        return nullptr;
+    }
+    return &entry;
+}
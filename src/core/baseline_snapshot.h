@@ -0,0 +1,125 @@
+#ifndef BASELINE_SNAPSHOT_H
+#define BASELINE_SNAPSHOT_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QSet>
+#include <QString>
+#include <memory>
+#include <vector>
+
+class FileManifest;
+
+// Configuration constants
+namespace SnapshotConfig {
+    constexpr quint32 MAGIC = 0x434F4253; // "COBS"
+    // Bumped whenever the format or the content hash changes, since
+    // recorded hashes and blob names would no longer match
+    constexpr quint32 VERSION = 4;
+    constexpr int BLOB_COMPRESSION_LEVEL = 1;
+    // Coarsest file system timestamp resolution allowed for (FAT, some
+    // network shares); files modified this close to a capture are re-read
+    constexpr qint64 MTIME_GRANULARITY_NS = 2000LL * 1000 * 1000;
+    // The pack is rewritten once unreferenced blobs outweigh live ones
+    constexpr double PACK_MAX_DEAD_RATIO = 0.5;
+}
+
+/**
+ * @brief File identity and fingerprint recorded in a snapshot
+ */
+struct SnapshotEntry {
+    qint64 size = 0;
+    qint64 mtimeNs = 0;
+    quint64 inode = 0;
+    quint64 hash = 0;
+};
+
+/**
+ * @brief Persisted baseline of one system's source root
+ *
+ * A snapshot is a manifest file listing every captured file with its size,
+ * modification time, inode and content hash, plus one append-only pack of
+ * compressed, content-addressed blobs holding the captured content. The
+ * manifest starts with an index of the pack sorted by hash, so a single
+ * blob is found by binary search without loading the whole manifest. On the
+ * next start files whose size, mtime and inode are unchanged reuse the
+ * recorded hash and are not read again; their old content is fetched from
+ * the pack only when the file actually changes. A file whose mtime is within
+ * the timestamp granularity of the capture (or later) is always read again,
+ * as git does for racily clean index entries: it may have been written
+ * again in the same tick after it was hashed. Snapshots live under the
+ * per-user app data directory, keyed by a hash of the system name and source
+ * root, so systems watching the same tree with different exclusions each
+ * keep their own manifest and pack instead of overwriting and pruning one
+ * another's. All other calls take the directory returned by locationFor().
+ */
+class BaselineSnapshot {
+public:
+    BaselineSnapshot();
+    ~BaselineSnapshot();
+    BaselineSnapshot(BaselineSnapshot&& other) noexcept;
+    BaselineSnapshot& operator=(BaselineSnapshot&& other) noexcept;
+
+    /**
+     * @brief Loads the snapshot stored at location for a source root
+     * @return An empty snapshot if none exists or it is unreadable or stale;
+     * either way new blobs can be written to it and it can be saved
+     */
+    static BaselineSnapshot load(const QString& location, const QString& sourceRoot);
+
+    /**
+     * @brief Writes the manifest for a capture, compacting the pack when
+     * mostly unreferenced
+     * @param hashes Content hash per manifest file, by manifest index
+     * @param captured Non-zero for manifest files that were read successfully
+     * @param captureTimeNs Wall-clock time the capture started reading files
+     */
+    bool save(const FileManifest& manifest,
+              const std::vector<quint64>& hashes,
+              const std::vector<char>& captured,
+              qint64 captureTimeNs);
+
+    /**
+     * @brief Appends content to the pack unless its hash is already there
+     *
+     * Thread-safe; readers of one capture write concurrently.
+     */
+    bool writeBlob(quint64 hash, const QByteArray& data);
+
+    bool hasBlob(quint64 hash) const;
+
+    /**
+     * @brief Reads content by hash from the saved snapshot at location,
+     * verifying it against the hash
+     */
+    static QByteArray readBlob(const QString& location, quint64 hash, bool* ok = nullptr);
+
+    /**
+     * @brief Directory holding the snapshot of a system's source root
+     */
+    static QString locationFor(const QString& systemName, const QString& sourceRoot);
+
+    bool isEmpty() const { return m_entries.isEmpty(); }
+    int size() const { return m_entries.size(); }
+
+    /**
+     * @brief Returns the recorded entry if the file is unchanged since, and
+     * was not modified too close to the capture to tell
+     */
+    const SnapshotEntry* findUnchanged(const QString& relativePath, qint64 size,
+                                       qint64 mtimeNs, quint64 inode) const;
+
+private:
+    struct Pack;
+
+    bool readManifest(const QString& sourceRoot);
+    bool compactPack(const QString& packName);
+    void removeStalePacks() const;
+
+    QString m_location;
+    QHash<QString, SnapshotEntry> m_entries;
+    qint64 m_captureTimeNs = 0;
+    std::unique_ptr<Pack> m_pack;
+};
+
+#endif // BASELINE_SNAPSHOT_H
@@ -0,0 +1,69 @@
+#include "baseline_store.h"
+
+const BaselineEntry* BaselineStore::find(const QString& relativePath) const
+{
+    const auto it = m_entries.constFind(relativePath);
+    return it == m_entries.constEnd() ? nullptr : &it.value();
+}
+
+void BaselineStore::insert(const QString& relativePath, const BaselineEntry& entry)
+{
+    auto it = m_entries.find(relativePath);
+    if (it != m_entries.end()) {
+        m_retainedCount -= it->hasContent() ? 1 : 0;
+        *it = entry;
+    } else {
+        m_entries.insert(relativePath, entry);
+    }
+    m_retainedCount += entry.hasContent() ? 1 : 0;
+}
+
+void BaselineStore::retainContent(const QString& relativePath, const BlobRef& content)
+{
+    auto it = m_entries.find(relativePath);
+    if (it == m_entries.end() || content.isNull()) {
+        return;
+    }
+    if (!it->hasContent()) {
+        ++m_retainedCount;
+    }
+    it->content = content;
+}
+
+void BaselineStore::markContentLost(const QString& relativePath)
+{
+    auto it = m_entries.find(relativePath);
+    if (it != m_entries.end() && !it->hasContent()) {
+        it->contentLost = true;
+    }
+}
+
+bool BaselineStore::rename(const QString& oldPath, const QString& newPath)
+{
+    auto it = m_entries.find(oldPath);
+    if (it == m_entries.end()) {
+        return false;
+    }
+
+    // Moving the entry keeps its BlobRef; no content is copied or re-read
+    BaselineEntry entry = std::move(it.value());
+    m_entries.erase(it);
+    remove(newPath);
+    m_entries.insert(newPath, std::move(entry));
+    return true;
+}
+
+void BaselineStore::remove(const QString& relativePath)
+{
+    auto it = m_entries.find(relativePath);
+    if (it != m_entries.end()) {
+        m_retainedCount -= it->hasContent() ? 1 : 0;
+        m_entries.erase(it);
+    }
+}
+
+void BaselineStore::clear()
+{
+    m_entries.clear();
+    m_retainedCount = 0;
+}
@@ -0,0 +1,79 @@
+#ifndef BASELINE_STORE_H
+#define BASELINE_STORE_H
+
+#include <QHash>
+#include <QString>
+#include <QStringList>
+
+#include "blob_store.h"
+
+/**
+ * @brief Baseline fingerprint of one file, with optional retained content
+ */
+struct BaselineEntry {
+    qint64 size = 0;
+    quint64 hash = 0;
+    // UTF-8 bytes shared through the BlobStore; hash-only baselines leave it
+    // null until the file changes and its old content is recovered
+    BlobRef content;
+    // Set when no matching copy of the old content could be found
+    bool contentLost = false;
+
+    bool hasContent() const { return !content.isNull(); }
+};
+
+/**
+ * @brief Per-system baseline keyed by root-relative path
+ *
+ * Every entry carries the size and content hash captured when watching
+ * started, which is all that is needed to tell real changes from false
+ * alarms. Full content is kept for every file in full mode, and only for
+ * files that actually changed in hash-only mode; either way it is held as a
+ * BlobRef, so identical files in other systems share one copy.
+ */
+class BaselineStore {
+public:
+    BaselineStore() = default;
+
+    bool contains(const QString& relativePath) const { return m_entries.contains(relativePath); }
+
+    /**
+     * @brief Looks up an entry; the pointer is invalidated by any mutation
+     */
+    const BaselineEntry* find(const QString& relativePath) const;
+
+    void insert(const QString& relativePath, const BaselineEntry& entry);
+
+    /**
+     * @brief Attaches recovered old content to an existing hash-only entry
+     */
+    void retainContent(const QString& relativePath, const BlobRef& content);
+
+    /**
+     * @brief Records that the old content of an entry cannot be recovered
+     */
+    void markContentLost(const QString& relativePath);
+
+    /**
+     * @brief Moves an entry to a new path, replacing any entry there
+     * @return false if there was no entry at the old path
+     */
+    bool rename(const QString& oldPath, const QString& newPath);
+
+    void remove(const QString& relativePath);
+    void clear();
+
+    int size() const { return m_entries.size(); }
+    QStringList keys() const { return m_entries.keys(); }
+
+    /**
+     * @brief Number of entries currently holding full content
+     */
+    int retainedCount() const { return m_retainedCount; }
+
+private:
+    QHash<QString, BaselineEntry> m_entries;
+    int m_retainedCount = 0;
+};
+
+#endif // BASELINE_STORE_H
@@ -0,0 +1,520 @@
+#include "blob_store.h"
+#include "../utils/content_hash.h"
+#include <QDir>
+#include <QMutexLocker>
+#include <QTemporaryFile>
+#include <cstring>
+#include <vector>
+
+BlobRef::BlobRef(quint64 key)
+    : m_key(key),
+      m_valid(true)
+{
+}
+
+BlobRef::BlobRef(const BlobRef& other)
+    : m_key(other.m_key),
+      m_valid(other.m_valid)
+{
+    if (m_valid) {
+        BlobStore::instance().retain(m_key);
+    }
+}
+
+BlobRef::BlobRef(BlobRef&& other) noexcept
+    : m_key(other.m_key),
+      m_valid(other.m_valid)
+{
+    other.m_valid = false;
+}
+
+BlobRef& BlobRef::operator=(const BlobRef& other)
+{
+    if (this != &other) {
+        BlobRef copy(other);
+        *this = std::move(copy);
+    }
+    return *this;
+}
+
+BlobRef& BlobRef::operator=(BlobRef&& other) noexcept
+{
+    if (this != &other) {
+        if (m_valid) {
+            BlobStore::instance().release(m_key);
+        }
+        m_key = other.m_key;
+        m_valid = other.m_valid;
+        other.m_valid = false;
+    }
+    return *this;
+}
+
+BlobRef::~BlobRef()
+{
+    if (m_valid) {
+        BlobStore::instance().release(m_key);
+    }
+}
+
+QByteArray BlobRef::data() const
+{
+    return m_valid ? BlobStore::instance().data(m_key) : QByteArray();
+}
+
+qint64 BlobRef::size() const
+{
+    return m_valid ? BlobStore::instance().rawSize(m_key) : 0;
+}
+
+BlobStore& BlobStore::instance()
+{
+    static BlobStore store;
+    return store;
+}
+
+BlobStore::BlobStore() = default;
+
+BlobStore::~BlobStore() = default;
+
+BlobRef BlobStore::intern(const QByteArray& data)
+{
+    return intern(data, ContentHasher::hash(data));
+}
+
+BlobRef BlobStore::intern(const QByteArray& data, quint64 hash)
+{
+    const qint64 rawSize = data.size();
+    quint64 key = 0;
+    BlobRef shared = findShared(data, hash, &key);
+    if (!shared.isNull()) {
+        return shared;
+    }
+
+    // Compress outside the lock so readers can intern in parallel
+    Blob blob;
+    blob.rawSize = rawSize;
+    blob.refCount = 1;
+    if (rawSize >= BlobStoreConfig::COMPRESS_MIN_BYTES) {
+        QByteArray compressed = qCompress(data, BlobStoreConfig::COMPRESSION_LEVEL);
+        if (compressed.size() < rawSize) {
+            blob.packed = std::move(compressed);
+            blob.compressed = true;
+        }
+    }
+    if (!blob.compressed) {
+        // data may be a raw view of a mapped file, so keep an owned copy
+        blob.packed = QByteArray(data.constData(), rawSize);
+    }
+    blob.packedSize = blob.packed.size();
+
+    BlobRef ref;
+    for (;;) {
+        {
+            QMutexLocker locker(&m_mutex);
+            if (!m_blobs.contains(key)) {
+                ref = insert(key, std::move(blob));
+                break;
+            }
+        }
+
+        // Another reader took the key meanwhile, possibly for the same content
+        shared = findShared(data, hash, &key);
+        if (!shared.isNull()) {
+            return shared;
+        }
+    }
+
+    // Make room by spilling cold blobs, the new one last. Only when the new
+    // one had to go and could not is the content refused and dropped again;
+    // other blobs failing to spill just stay resident.
+    bool stuck = false;
+    enforceBudget(key, &stuck);
+    if (stuck) {
+        ref = BlobRef();
+        QMutexLocker locker(&m_mutex);
+        m_rejectedBytes += rawSize;
+        return BlobRef();
+    }
+    return ref;
+}
+
+BlobRef BlobStore::insert(quint64 key, Blob&& blob)
+{
+    m_rawBytes += blob.rawSize;
+    m_referencedBytes += blob.rawSize;
+    m_storedBytes += blob.packedSize;
+    auto it = m_blobs.insert(key, std::move(blob));
+    m_lru.push_front(key);
+    it->lruPosition = m_lru.begin();
+    return BlobRef(key);
+}
+
+BlobRef BlobStore::findShared(const QByteArray& data, quint64 hash, quint64* freeKey)
+{
+    quint64 key = hash;
+    for (;; ++key) {
+        {
+            QMutexLocker locker(&m_mutex);
+            key = probe(key, data.size());
+            auto it = m_blobs.find(key);
+            if (it == m_blobs.end()) {
+                *freeKey = key;
+                return BlobRef();
+            }
+
+            // Raw resident bytes are compared in place
+            if (!it->compressed && it->spillOffset < 0) {
+                if (std::memcmp(it->packed.constData(), data.constData(), size_t(data.size())) != 0) {
+                    continue;
+                }
+                ++it->refCount;
+                touch(*it);
+                m_referencedBytes += it->rawSize;
+                return BlobRef(key);
+            }
+
+            // Hold a reference so the candidate stays put while it is
+            // inflated or read back outside the lock
+            ++it->refCount;
+            m_referencedBytes += it->rawSize;
+        }
+
+        BlobRef candidate(key);
+        if (candidate.data() == data) {
+            return candidate;
+        }
+    }
+}
+
+void BlobStore::touch(Blob& blob)
+{
+    if (blob.spillOffset < 0 && !blob.spilling) {
+        m_lru.splice(m_lru.begin(), m_lru, blob.lruPosition);
+    }
+}
+
+void BlobStore::enforceBudget(quint64 key, bool* keyStuck)
+{
+    if (keyStuck) {
+        *keyStuck = false;
+    }
+
+    struct Victim {
+        quint64 key;
+        QByteArray packed;
+        qint64 offset;
+    };
+    std::vector<Victim> victims;
+
+    // Pick the coldest blobs and reserve their spill ranges. They stay
+    // readable from memory, and pinned, until their bytes are on disk.
+    {
+        QMutexLocker locker(&m_mutex);
+        if (m_memoryBudget <= 0) {
+            return;
+        }
+        qint64 resident = m_storedBytes - m_spillingBytes;
+        while (resident > m_memoryBudget && !m_lru.empty()) {
+            const quint64 coldest = m_lru.back();
+            m_lru.pop_back();
+            Blob& blob = m_blobs[coldest];
+            blob.spilling = true;
+            ++blob.refCount;
+            m_spillingBytes += blob.packedSize;
+            resident -= blob.packedSize;
+            victims.push_back({coldest, blob.packed, allocateSpill(blob.packedSize)});
+        }
+        if (victims.empty()) {
+            return;
+        }
+    }
+
+    // Write without holding m_mutex, so interning readers are not blocked
+    size_t written = 0;
+    {
+        QMutexLocker spillLocker(&m_spillMutex);
+        if (openSpillFile()) {
+            while (written < victims.size()) {
+                const Victim& victim = victims[written];
+                if (!m_spillFile->seek(victim.offset) ||
+                    m_spillFile->write(victim.packed) != victim.packed.size()) {
+                    break;
+                }
+                ++written;
+            }
+            if (!m_spillFile->flush()) {
+                written = 0;
+            }
+        }
+    }
+
+    // Hand the written blobs over to the spill file. The rest go back to
+    // the cold end of the LRU list, coldest last.
+    QMutexLocker locker(&m_mutex);
+    for (size_t i = victims.size(); i-- > 0;) {
+        auto it = m_blobs.find(victims[i].key);
+        it->spilling = false;
+        m_spillingBytes -= it->packedSize;
+        if (i < written) {
+            it->packed = QByteArray();
+            it->spillOffset = victims[i].offset;
+            m_storedBytes -= it->packedSize;
+            m_spilledBytes += it->packedSize;
+        } else {
+            freeSpill(victims[i].offset, it->packedSize);
+            m_lru.push_back(victims[i].key);
+            it->lruPosition = std::prev(m_lru.end());
+            if (keyStuck && victims[i].key == key) {
+                *keyStuck = true;
+            }
+        }
+        if (--it->refCount == 0) {
+            drop(it);
+        }
+    }
+}
+
+bool BlobStore::openSpillFile()
+{
+    if (!m_spillFile && !m_spillFailed) {
+        auto file = std::make_unique<QTemporaryFile>(
+            QDir::tempPath() + QStringLiteral("/compare-observer-spill-XXXXXX"));
+        if (file->open()) {
+            m_spillFile = std::move(file);
+        } else {
+            m_spillFailed = true;
+        }
+    }
+    return m_spillFile != nullptr;
+}
+
+qint64 BlobStore::allocateSpill(qint64 size)
+{
+    // First fit among the freed ranges, else grow the file
+    for (auto gap = m_spillGaps.begin(); gap != m_spillGaps.end(); ++gap) {
+        if (gap->second >= size) {
+            const qint64 offset = gap->first;
+            const qint64 rest = gap->second - size;
+            m_spillGaps.erase(gap);
+            if (rest > 0) {
+                m_spillGaps.emplace(offset + size, rest);
+            }
+            return offset;
+        }
+    }
+    const qint64 offset = m_spillEnd;
+    m_spillEnd += size;
+    return offset;
+}
+
+void BlobStore::freeSpill(qint64 offset, qint64 size)
+{
+    if (size == 0) {
+        return;
+    }
+
+    // Merge with the neighbouring free ranges
+    auto next = m_spillGaps.lower_bound(offset);
+    if (next != m_spillGaps.end() && offset + size == next->first) {
+        size += next->second;
+        next = m_spillGaps.erase(next);
+    }
+    if (next != m_spillGaps.begin()) {
+        const auto previous = std::prev(next);
+        if (previous->first + previous->second == offset) {
+            offset = previous->first;
+            size += previous->second;
+            m_spillGaps.erase(previous);
+        }
+    }
+
+    // A free range at the end shrinks the file instead
+    if (offset + size == m_spillEnd) {
+        m_spillEnd = offset;
+        m_spillTrimPending = true;
+    } else {
+        m_spillGaps.emplace(offset, size);
+    }
+}
+
+void BlobStore::trimSpill()
+{
+    QMutexLocker spillLocker(&m_spillMutex);
+    qint64 end = 0;
+    {
+        QMutexLocker locker(&m_mutex);
+        if (!m_spillTrimPending) {
+            return;
+        }
+        m_spillTrimPending = false;
+        end = m_spillEnd;
+    }
+
+    // Ranges reserved meanwhile lie beyond end, but are only written once
+    // m_spillMutex is free again; the write extends the file as needed
+    if (m_spillFile && m_spillFile->size() > end) {
+        m_spillFile->resize(end);
+    }
+}
+
+void BlobStore::drop(QHash<quint64, Blob>::iterator it)
+{
+    if (it->spillOffset < 0) {
+        m_storedBytes -= it->packedSize;
+        m_lru.erase(it->lruPosition);
+    } else {
+        m_spilledBytes -= it->packedSize;
+        freeSpill(it->spillOffset, it->packedSize);
+    }
+    m_rawBytes -= it->rawSize;
+    m_blobs.erase(it);
+}
+
+quint64 BlobStore::probe(quint64 key, qint64 rawSize) const
+{
+    for (;; ++key) {
+        const auto it = m_blobs.constFind(key);
+        if (it == m_blobs.constEnd() || it->rawSize == rawSize) {
+            return key;
+        }
+    }
+}
+
+void BlobStore::retain(quint64 key)
+{
+    QMutexLocker locker(&m_mutex);
+    auto it = m_blobs.find(key);
+    if (it != m_blobs.end()) {
+        ++it->refCount;
+        m_referencedBytes += it->rawSize;
+    }
+}
+
+void BlobStore::release(quint64 key)
+{
+    bool trim = false;
+    {
+        QMutexLocker locker(&m_mutex);
+        auto it = m_blobs.find(key);
+        if (it == m_blobs.end()) {
+            return;
+        }
+
+        m_referencedBytes -= it->rawSize;
+        if (--it->refCount > 0) {
+            return;
+        }
+        drop(it);
+        trim = m_spillTrimPending;
+    }
+
+    if (trim) {
+        trimSpill();
+    }
+}
+
+QByteArray BlobStore::data(quint64 key)
+{
+    QByteArray packed;
+    qint64 spillOffset = -1;
+    qint64 packedSize = 0;
+    bool compressed = false;
+    {
+        QMutexLocker locker(&m_mutex);
+        auto it = m_blobs.find(key);
+        if (it == m_blobs.end()) {
+            return QByteArray();
+        }
+        compressed = it->compressed;
+        packedSize = it->packedSize;
+        spillOffset = it->spillOffset;
+        if (spillOffset < 0) {
+            touch(*it);
+            packed = it->packed;
+        }
+    }
+
+    // Inflate outside the lock; packed shares the stored buffer
+    if (spillOffset < 0) {
+        return compressed ? qUncompress(packed) : packed;
+    }
+    if (packedSize == 0) {
+        return QByteArray();
+    }
+
+    // The caller holds a reference, so this range is neither reused nor
+    // truncated while it is mapped
+    QMutexLocker spillLocker(&m_spillMutex);
+    uchar* mapped = m_spillFile->map(spillOffset, packedSize);
+    if (!mapped) {
+        return QByteArray();
+    }
+    spillLocker.unlock();
+
+    QByteArray result = compressed
+        ? qUncompress(mapped, packedSize)
+        : QByteArray(reinterpret_cast<const char*>(mapped), packedSize);
+
+    spillLocker.relock();
+    m_spillFile->unmap(mapped);
+    return result;
+}
+
+qint64 BlobStore::rawSize(quint64 key) const
+{
+    QMutexLocker locker(&m_mutex);
+    const auto it = m_blobs.constFind(key);
+    return it == m_blobs.constEnd() ? 0 : it->rawSize;
+}
+
+void BlobStore::setMemoryBudget(qint64 bytes)
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        m_memoryBudget = qMax<qint64>(0, bytes);
+    }
+    enforceBudget();
+}
+
+qint64 BlobStore::memoryBudget() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_memoryBudget;
+}
+
+int BlobStore::blobCount() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_blobs.size();
+}
+
+qint64 BlobStore::storedBytes() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_storedBytes;
+}
+
+qint64 BlobStore::spilledBytes() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_spilledBytes;
+}
+
+qint64 BlobStore::rawBytes() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_rawBytes;
+}
+
+qint64 BlobStore::referencedBytes() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_referencedBytes;
+}
+
+qint64 BlobStore::rejectedBytes() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_rejectedBytes;
+}
@@ -0,0 +1,198 @@
+#ifndef BLOB_STORE_H
+#define BLOB_STORE_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QMutex>
+#include <list>
+#include <map>
+#include <memory>
+
+class QTemporaryFile;
+
+// Configuration constants
+namespace BlobStoreConfig {
+    // Smaller blobs gain little from compression and stay raw
+    constexpr int COMPRESS_MIN_BYTES = 256;
+    // zlib level 1 favours speed; source code still shrinks several times
+    constexpr int COMPRESSION_LEVEL = 1;
+}
+
+/**
+ * @brief Counted reference to content held by the BlobStore
+ *
+ * Copying a reference shares the blob; the blob is freed when the last
+ * reference goes away. A default-constructed reference is null.
+ */
+class BlobRef {
+public:
+    BlobRef() = default;
+    BlobRef(const BlobRef& other);
+    BlobRef(BlobRef&& other) noexcept;
+    BlobRef& operator=(const BlobRef& other);
+    BlobRef& operator=(BlobRef&& other) noexcept;
+    ~BlobRef();
+
+    bool isNull() const { return !m_valid; }
+
+    /**
+     * @brief Returns the referenced bytes, decompressing them if needed
+     */
+    QByteArray data() const;
+
+    /**
+     * @brief Uncompressed size, without decompressing
+     */
+    qint64 size() const;
+
+private:
+    friend class BlobStore;
+    explicit BlobRef(quint64 key);
+
+    quint64 m_key = 0;
+    bool m_valid = false;
+};
+
+/**
+ * @brief Process-wide content-addressed store for baseline content
+ *
+ * Content is keyed by its hash and reference counted, so identical files
+ * across systems and across re-baselines are kept in memory once. A blob is
+ * only shared once its bytes compare equal to the new content; on a hash
+ * collision the new content is stored under the next free key. Blobs are kept
+ * zlib-compressed and only inflated when a diff needs them. When the
+ * resident total exceeds the memory budget, the least recently used blobs
+ * are moved to a temporary spill file and mapped back in when read. The
+ * file is written outside the store's lock, and ranges of released blobs
+ * are reused, so it stays about as large as the live spilled content. Only
+ * if the spill file cannot be written is new content refused, in which case
+ * callers fall back to a hash-only baseline. Thread-safe; baseline readers
+ * intern content directly from the worker threads.
+ */
+class BlobStore {
+public:
+    static BlobStore& instance();
+
+    // Delete copy constructor and assignment
+    BlobStore(const BlobStore&) = delete;
+    BlobStore& operator=(const BlobStore&) = delete;
+    ~BlobStore();
+
+    /**
+     * @brief Returns a reference to stored content equal to data
+     * @param data Content; may be a raw view, the store keeps its own copy
+     * @param hash ContentHasher hash of data
+     * @return A null reference if it could neither be kept nor spilled
+     */
+    BlobRef intern(const QByteArray& data, quint64 hash);
+    BlobRef intern(const QByteArray& data);
+
+    /**
+     * @brief Sets the limit for resident (compressed) bytes; 0 means unlimited
+     */
+    void setMemoryBudget(qint64 bytes);
+    qint64 memoryBudget() const;
+
+    /**
+     * @brief Number of distinct blobs held
+     */
+    int blobCount() const;
+
+    /**
+     * @brief Bytes resident in memory, compressed, counting each blob once
+     */
+    qint64 storedBytes() const;
+
+    /**
+     * @brief Bytes of live blobs moved to the spill file
+     */
+    qint64 spilledBytes() const;
+
+    /**
+     * @brief Uncompressed size of the distinct blobs held
+     */
+    qint64 rawBytes() const;
+
+    /**
+     * @brief Uncompressed bytes that would be held without sharing
+     */
+    qint64 referencedBytes() const;
+
+    /**
+     * @brief Uncompressed bytes refused because they could not be spilled
+     */
+    qint64 rejectedBytes() const;
+
+private:
+    friend class BlobRef;
+    BlobStore();
+
+    struct Blob {
+        // Empty once the blob has been spilled
+        QByteArray packed;
+        qint64 packedSize = 0;
+        qint64 rawSize = 0;
+        // Position in the spill file, or -1 while resident
+        qint64 spillOffset = -1;
+        bool compressed = false;
+        // Being written to the spill file; still resident, not in the LRU
+        bool spilling = false;
+        int refCount = 0;
+        std::list<quint64>::iterator lruPosition;
+    };
+
+    void retain(quint64 key);
+    void release(quint64 key);
+    QByteArray data(quint64 key);
+    qint64 rawSize(quint64 key) const;
+
+    // Returns a reference to a blob whose bytes equal data, or a null
+    // reference and the first free key probed from hash
+    BlobRef findShared(const QByteArray& data, quint64 hash, quint64* freeKey);
+
+    // First key from key on that is free or holds a blob of rawSize bytes
+    quint64 probe(quint64 key, qint64 rawSize) const;
+
+    // Spills the coldest blobs until the resident bytes fit the budget;
+    // blobs the spill file could not take stay resident. If keyStuck is
+    // given, it tells whether the blob under key was one of them. Takes
+    // both locks itself.
+    void enforceBudget(quint64 key = 0, bool* keyStuck = nullptr);
+    // Shrinks the spill file after its last ranges were freed
+    void trimSpill();
+    // Expects m_spillMutex to be held
+    bool openSpillFile();
+
+    // All of the following expect m_mutex to be held
+    BlobRef insert(quint64 key, Blob&& blob);
+    void touch(Blob& blob);
+    void drop(QHash<quint64, Blob>::iterator it);
+    qint64 allocateSpill(qint64 size);
+    void freeSpill(qint64 offset, qint64 size);
+
+    // Guards the blob table, the LRU list and the spill range bookkeeping
+    mutable QMutex m_mutex;
+    // Guards the spill file itself; may be held while taking m_mutex, never
+    // the other way round
+    QMutex m_spillMutex;
+    QHash<quint64, Blob> m_blobs;
+    // Resident blob keys, most recently used first
+    std::list<quint64> m_lru;
+    std::unique_ptr<QTemporaryFile> m_spillFile;
+    bool m_spillFailed = false;
+    // Free ranges inside the spill file by offset, merged with neighbours
+    std::map<qint64, qint64> m_spillGaps;
+    // End of the last range in use; the file is trimmed down to it
+    qint64 m_spillEnd = 0;
+    bool m_spillTrimPending = false;
+    // Resident bytes currently being written out
+    qint64 m_spillingBytes = 0;
+    qint64 m_memoryBudget = 0;
+    qint64 m_storedBytes = 0;
+    qint64 m_spilledBytes = 0;
+    qint64 m_rawBytes = 0;
+    qint64 m_referencedBytes = 0;
+    qint64 m_rejectedBytes = 0;
+};
+
+#endif // BLOB_STORE_H
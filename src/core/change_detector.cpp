@@ -0,0 +1,73 @@
+#include "change_detector.h"
+#include "baseline_store.h"
+#include "../utils/mapped_file.h"
+#include <QFileInfo>
+
+ChangeDetector::Result ChangeDetector::check(const QString& filePath, const BaselineEntry& baseline)
+{
+    Result result;
+    ++m_stats.checks;
+
+    // Tier 1: stat() only, the file is not opened
+    const QFileInfo fileInfo(filePath);
+    if (!fileInfo.exists()) {
+        return result;
+    }
+    result.newSize = fileInfo.size();
+    if (result.newSize != baseline.size) {
+        ++m_stats.sizeMismatches;
+        result.verdict = Verdict::Changed;
+        result.tier = Tier::Size;
+        return result;
+    }
+
+    // Tier 2: hash the mapped bytes and compare with the stored hash
+    MappedFile file(filePath);
+    bool ok = false;
+    const quint64 hash = file.hash(&ok);
+    if (!ok) {
+        return result;
+    }
+    result.newSize = file.size();
+    result.tier = Tier::Hash;
+    if (result.newSize != baseline.size || hash != baseline.hash) {
+        ++m_stats.hashMismatches;
+        result.verdict = Verdict::Changed;
+        return result;
+    }
+    ++m_stats.hashMatches;
+
+    // Tier 3: equal hashes are trusted unless the old bytes are available
+    // to rule out a collision
+    if (!baseline.hasContent()) {
+        result.verdict = Verdict::Identical;
+        return result;
+    }
+
+    ++m_stats.fullCompares;
+    const bool equal = file.equals(baseline.content.data(), &ok);
+    if (!ok) {
+        result.verdict = Verdict::Unreadable;
+        return result;
+    }
+    result.tier = Tier::FullCompare;
+    result.newSize = file.size();
+    if (!equal) {
+        ++m_stats.collisions;
+    }
+    result.verdict = equal ? Verdict::Identical : Verdict::Changed;
+    return result;
+}
+
+QString ChangeDetector::tierName(Tier tier)
+{
+    switch (tier) {
+        case Tier::Size:
+            return "size";
+        case Tier::Hash:
+            return "hash";
+        case Tier::FullCompare:
+            return "full compare";
+    }
+    return QString();
+}
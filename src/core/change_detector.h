@@ -0,0 +1,61 @@
+#ifndef CHANGE_DETECTOR_H
+#define CHANGE_DETECTOR_H
+
+#include <QString>
+#include <QtGlobal>
+
+struct BaselineEntry;
+
+/**
+ * @brief Decides whether a file really differs from its baseline
+ *
+ * Checks run from cheapest to most expensive and stop at the first
+ * conclusive tier: a size mismatch from stat(), then the stored hash
+ * against a hash of the file's mapped bytes, and a byte-for-byte compare
+ * only when the hashes match and the baseline content is at hand, to rule
+ * out a collision. Nothing is decoded to text. Counts how many checks each
+ * tier settled.
+ */
+class ChangeDetector {
+public:
+    enum class Verdict {
+        Identical,
+        Changed,
+        Unreadable
+    };
+
+    enum class Tier {
+        Size,
+        Hash,
+        FullCompare
+    };
+
+    struct Result {
+        Verdict verdict = Verdict::Unreadable;
+        Tier tier = Tier::Size;
+        qint64 newSize = 0;
+    };
+
+    struct Stats {
+        quint64 checks = 0;
+        quint64 sizeMismatches = 0;
+        quint64 hashMismatches = 0;
+        quint64 hashMatches = 0;
+        quint64 fullCompares = 0;
+        quint64 collisions = 0;
+    };
+
+    ChangeDetector() = default;
+
+    Result check(const QString& filePath, const BaselineEntry& baseline);
+
+    const Stats& stats() const { return m_stats; }
+    void resetStats() { m_stats = Stats(); }
+
+    static QString tierName(Tier tier);
+
+private:
+    Stats m_stats;
+};
+
+#endif // CHANGE_DETECTOR_H
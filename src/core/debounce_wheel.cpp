@@ -0,0 +1,136 @@
+#include "debounce_wheel.h"
+
+DebounceWheel::DebounceWheel(qint64 quietPeriodMs)
+    : m_slots(DebounceConfig::WHEEL_SLOTS),
+      m_quietMs(0),
+      m_tickMs(DebounceConfig::MIN_TICK_MS)
+{
+    setQuietPeriod(quietPeriodMs);
+}
+
+void DebounceWheel::setQuietPeriod(qint64 ms)
+{
+    if (!m_pending.isEmpty()) {
+        return;
+    }
+
+    m_quietMs = qMax<qint64>(0, ms);
+    const qint64 halfTurn = DebounceConfig::WHEEL_SLOTS / 2;
+    m_tickMs = qMax(DebounceConfig::MIN_TICK_MS, (m_quietMs + halfTurn - 1) / halfTurn);
+}
+
+void DebounceWheel::schedule(const QString& path, FileEvent::Kind kind, qint64 nowMs)
+{
+    if (m_pending.isEmpty()) {
+        // Idle wheel: nothing to catch up on, restart from the present
+        m_currentTick = nowMs / m_tickMs;
+    }
+
+    auto it = m_pending.find(path);
+    if (it == m_pending.end()) {
+        Pending pending;
+        pending.kind = kind;
+        pending.firstMs = nowMs;
+        pending.dueTick = -1;
+        it = m_pending.insert(path, pending);
+    } else {
+        it->kind = FileEvent::merge(it->kind, kind);
+    }
+
+    const qint64 latestMs = it->firstMs + DebounceConfig::MAX_DEFER_PERIODS * m_quietMs;
+    const qint64 dueMs = qMin(nowMs + m_quietMs, latestMs);
+    const qint64 dueTick = qMax(m_currentTick + 1, (dueMs + m_tickMs - 1) / m_tickMs);
+    if (dueTick != it->dueTick) {
+        it->dueTick = dueTick;
+        m_slots[int(dueTick % DebounceConfig::WHEEL_SLOTS)].append(path);
+    }
+}
+
+void DebounceWheel::rename(const QString& oldPath, const QString& newPath, bool isDirectory, qint64 nowMs)
+{
+    const QString prefix = oldPath + QLatin1Char('/');
+    FileEventBatch moved;
+    for (auto it = m_pending.begin(); it != m_pending.end();) {
+        const QString& path = it.key();
+        if (isDirectory ? !path.startsWith(prefix) : path != oldPath) {
+            ++it;
+            continue;
+        }
+        // The slot reference left behind is dropped as stale
+        moved.append(FileEvent{newPath + path.mid(oldPath.size()), it->kind});
+        it = m_pending.erase(it);
+    }
+
+    for (const FileEvent& event : moved) {
+        schedule(event.path, event.kind, nowMs);
+    }
+}
+
+void DebounceWheel::removeDirectory(const QString& path)
+{
+    const QString prefix = path + QLatin1Char('/');
+    for (auto it = m_pending.begin(); it != m_pending.end();) {
+        if (it.key().startsWith(prefix)) {
+            // The slot reference left behind is dropped as stale
+            it = m_pending.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+FileEventBatch DebounceWheel::advance(qint64 nowMs)
+{
+    FileEventBatch fired;
+    const qint64 targetTick = nowMs / m_tickMs;
+    if (m_pending.isEmpty()) {
+        m_currentTick = targetTick;
+        return fired;
+    }
+
+    // After a stall longer than a turn every slot is visited once
+    const qint64 steps = qMin<qint64>(targetTick - m_currentTick, DebounceConfig::WHEEL_SLOTS);
+    for (qint64 step = 1; step <= steps; ++step) {
+        const int slotIndex = int((m_currentTick + step) % DebounceConfig::WHEEL_SLOTS);
+        QVector<QString>& slot = m_slots[slotIndex];
+        QVector<QString> later;
+        for (const QString& path : slot) {
+            auto it = m_pending.find(path);
+            if (it == m_pending.end() || it->dueTick % DebounceConfig::WHEEL_SLOTS != slotIndex) {
+                // Fired already or re-armed into another slot
+                continue;
+            }
+            if (it->dueTick > targetTick) {
+                later.append(path);
+                continue;
+            }
+            fired.append(FileEvent{path, it->kind});
+            m_pending.erase(it);
+        }
+        slot.swap(later);
+    }
+
+    m_currentTick = targetTick;
+    if (m_pending.isEmpty()) {
+        // Drop stale references so an idle wheel holds nothing
+        for (QVector<QString>& slot : m_slots) {
+            slot.clear();
+        }
+    }
+    return fired;
+}
+
+FileEventBatch DebounceWheel::takeAll()
+{
+    FileEventBatch events;
+    events.reserve(m_pending.size());
+    for (auto it = m_pending.cbegin(); it != m_pending.cend(); ++it) {
+        events.append(FileEvent{it.key(), it->kind});
+    }
+
+    m_pending.clear();
+    for (QVector<QString>& slot : m_slots) {
+        slot.clear();
+    }
+    return events;
+}
@@ -0,0 +1,90 @@
+#ifndef DEBOUNCE_WHEEL_H
+#define DEBOUNCE_WHEEL_H
+
+#include <QHash>
+#include <QString>
+#include <QVector>
+
+#include "file_event.h"
+
+// Configuration constants
+namespace DebounceConfig {
+    // Slots on the wheel; the tick is sized so one turn spans twice the
+    // quiet period and every deadline lands within a single turn
+    constexpr int WHEEL_SLOTS = 64;
+    constexpr qint64 MIN_TICK_MS = 10;
+    // A path written continuously still fires this many quiet periods
+    // after its first event
+    constexpr int MAX_DEFER_PERIODS = 4;
+}
+
+/**
+ * @brief Trailing-edge debounce of file events, keyed by path
+ *
+ * Each event (re)arms a deadline one quiet period after it; a path fires
+ * once, with the merged kind of all its events, when no event has arrived
+ * for a full quiet period. Deadlines sit in a hashed timer wheel, so
+ * scheduling and expiry are O(1) per event regardless of how many paths
+ * are pending. Only pending paths are held; an entry is dropped as soon as
+ * it fires. Times are milliseconds from a monotonic clock supplied by the
+ * caller. Not thread-safe.
+ */
+class DebounceWheel {
+public:
+    explicit DebounceWheel(qint64 quietPeriodMs = 500);
+
+    /**
+     * @brief Changes the quiet period; only takes effect while nothing is pending
+     */
+    void setQuietPeriod(qint64 ms);
+    qint64 quietPeriod() const { return m_quietMs; }
+
+    /**
+     * @brief Interval at which advance() should be called while non-empty
+     */
+    qint64 tickInterval() const { return m_tickMs; }
+
+    void schedule(const QString& path, FileEvent::Kind kind, qint64 nowMs);
+
+    /**
+     * @brief Moves pending events at or below oldPath to the new location,
+     * re-arming them from nowMs
+     */
+    void rename(const QString& oldPath, const QString& newPath, bool isDirectory, qint64 nowMs);
+
+    /**
+     * @brief Drops the pending events below a directory that left the tree
+     */
+    void removeDirectory(const QString& path);
+
+    /**
+     * @brief Removes and returns the paths whose quiet period ended by nowMs
+     */
+    FileEventBatch advance(qint64 nowMs);
+
+    /**
+     * @brief Removes and returns everything pending, e.g. on shutdown
+     */
+    FileEventBatch takeAll();
+
+    bool contains(const QString& path) const { return m_pending.contains(path); }
+    bool isEmpty() const { return m_pending.isEmpty(); }
+    int size() const { return m_pending.size(); }
+
+private:
+    struct Pending {
+        FileEvent::Kind kind = FileEvent::Kind::Changed;
+        qint64 firstMs = 0;
+        qint64 dueTick = 0;
+    };
+
+    QHash<QString, Pending> m_pending;
+    // Paths by due tick modulo WHEEL_SLOTS; re-armed paths leave a stale
+    // reference behind that is dropped when its slot comes round
+    QVector<QVector<QString>> m_slots;
+    qint64 m_quietMs;
+    qint64 m_tickMs;
+    qint64 m_currentTick = 0;
+};
+
+#endif // DEBOUNCE_WHEEL_H
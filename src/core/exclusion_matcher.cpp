@@ -0,0 +1,192 @@
+#include "exclusion_matcher.h"
+#include <QVarLengthArray>
+
+namespace {
+    constexpr quint64 FNV_OFFSET_BASIS = 14695981039346656037ULL;
+    constexpr quint64 FNV_PRIME = 1099511628211ULL;
+
+    // Typical source trees are far shallower; deeper paths spill to the heap
+    constexpr int INLINE_PATH_DEPTH = 32;
+
+    inline bool isSeparator(QChar ch)
+    {
+        return ch == QLatin1Char('/') || ch == QLatin1Char('\\');
+    }
+
+    template <typename Callback>
+    void forEachComponent(QStringView path, Callback&& callback)
+    {
+        qsizetype start = 0;
+        const qsizetype length = path.size();
+        for (qsizetype i = 0; i <= length; ++i) {
+            if (i == length || isSeparator(path[i])) {
+                if (i > start) {
+                    callback(path.mid(start, i - start));
+                }
+                start = i + 1;
+            }
+        }
+    }
+}
+
+ExclusionMatcher::ExclusionMatcher(const QStringList& excludedFolders, const QStringList& excludedFiles)
+{
+    for (const QString& folder : excludedFolders) {
+        const QString trimmed = folder.trimmed();
+        if (!trimmed.isEmpty()) {
+            addComponentRule(trimmed);
+        }
+    }
+
+    for (const QString& file : excludedFiles) {
+        const QString trimmed = file.trimmed();
+        if (trimmed.isEmpty()) {
+            continue;
+        }
+
+        // Entries without an extension (or dot-folders) are treated as folders
+        const bool isFolder = !trimmed.contains('.') || trimmed.startsWith('.');
+        if (isFolder) {
+            addComponentRule(trimmed);
+        } else {
+            addFileNameRule(trimmed);
+        }
+    }
+}
+
+void ExclusionMatcher::addComponentRule(const QString& rule)
+{
+    QStringList components;
+    forEachComponent(rule, [&components](QStringView component) {
+        components << component.toString();
+    });
+
+    if (components.isEmpty()) {
+        return;
+    }
+
+    if (components.size() == 1) {
+        m_componentRules[foldedHash(components.first())].append(components.first());
+    } else {
+        m_multiComponentRules.append(components);
+    }
+    ++m_ruleCount;
+}
+
+void ExclusionMatcher::addFileNameRule(const QString& rule)
+{
+    m_fileNameRules[foldedHash(rule)].append(rule);
+    ++m_ruleCount;
+}
+
+quint64 ExclusionMatcher::foldedHash(QStringView text)
+{
+    // FNV-1a over case-folded UTF-16 units, so "Build" and "build" collide
+    quint64 hash = FNV_OFFSET_BASIS;
+    for (QChar ch : text) {
+        hash ^= ch.toCaseFolded().unicode();
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+bool ExclusionMatcher::containsRule(const QHash<quint64, QVector<QString>>& rules, QStringView text)
+{
+    const auto it = rules.constFind(foldedHash(text));
+    if (it == rules.constEnd()) {
+        return false;
+    }
+
+    for (const QString& rule : it.value()) {
+        if (text.compare(rule, Qt::CaseInsensitive) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ExclusionMatcher::isBuiltInExcluded(QStringView fileName)
+{
+    // Exclude editor backup files
+    if (fileName.endsWith(QLatin1Char('~'))) {
+        return true;
+    }
+
+    // Exclude vim swap files
+    if (fileName.endsWith(QLatin1String(".swp")) || fileName.endsWith(QLatin1String(".swo")) ||
+        (fileName.startsWith(QLatin1Char('.')) && fileName.contains(QLatin1String(".sw")))) {
+        return true;
+    }
+
+    // Exclude common temp files
+    return fileName.endsWith(QLatin1String(".tmp")) || fileName.endsWith(QLatin1String(".temp")) ||
+           fileName.endsWith(QLatin1String(".bak")) || fileName.endsWith(QLatin1String(".old"));
+}
+
+template <typename Components>
+bool ExclusionMatcher::matchesFolderRules(const Components& components) const
+{
+    if (!m_componentRules.isEmpty()) {
+        for (QStringView component : components) {
+            if (containsRule(m_componentRules, component)) {
+                return true;
+            }
+        }
+    }
+
+    // Multi-component folder rules must match a consecutive run of components
+    for (const QStringList& rule : m_multiComponentRules) {
+        const qsizetype ruleLength = rule.size();
+        for (qsizetype start = 0; start + ruleLength <= components.size(); ++start) {
+            bool matched = true;
+            for (qsizetype i = 0; i < ruleLength; ++i) {
+                if (components[start + i].compare(rule[i], Qt::CaseInsensitive) != 0) {
+                    matched = false;
+                    break;
+                }
+            }
+            if (matched) {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+bool ExclusionMatcher::isExcluded(QStringView path) const
+{
+    QVarLengthArray<QStringView, INLINE_PATH_DEPTH> components;
+    forEachComponent(path, [&components](QStringView component) {
+        components.append(component);
+    });
+
+    if (components.isEmpty()) {
+        return false;
+    }
+
+    const QStringView fileName = components.last();
+    if (isBuiltInExcluded(fileName)) {
+        return true;
+    }
+
+    if (!m_fileNameRules.isEmpty() && containsRule(m_fileNameRules, fileName)) {
+        return true;
+    }
+
+    return matchesFolderRules(components);
+}
+
+bool ExclusionMatcher::isDirectoryExcluded(QStringView dirPath) const
+{
+    if (m_componentRules.isEmpty() && m_multiComponentRules.isEmpty()) {
+        return false;
+    }
+
+    QVarLengthArray<QStringView, INLINE_PATH_DEPTH> components;
+    forEachComponent(dirPath, [&components](QStringView component) {
+        components.append(component);
+    });
+
+    return matchesFolderRules(components);
+}
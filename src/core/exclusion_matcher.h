@@ -0,0 +1,68 @@
+#ifndef EXCLUSION_MATCHER_H
+#define EXCLUSION_MATCHER_H
+
+#include <QString>
+#include <QStringList>
+#include <QStringView>
+#include <QHash>
+#include <QVector>
+
+/**
+ * @brief Precompiled matcher for the Except/Without exclusion rules
+ *
+ * Rules are trimmed, case-folded and hashed once at construction. Matching
+ * walks the path components as views and does hashed lookups, so checking a
+ * path does not allocate. Built-in rules skip editor backups, swap and
+ * temporary files. Immutable after construction and safe to share between
+ * threads.
+ */
+class ExclusionMatcher {
+public:
+    ExclusionMatcher() = default;
+
+    /**
+     * @brief Compiles the rule lists
+     * @param excludedFolders Folder names excluded anywhere in the path
+     * @param excludedFiles File names (or folder names without extension)
+     */
+    ExclusionMatcher(const QStringList& excludedFolders, const QStringList& excludedFiles);
+
+    /**
+     * @brief Checks whether a path matches any built-in or configured rule
+     * @param path Absolute path using either '/' or '\' separators
+     */
+    bool isExcluded(QStringView path) const;
+
+    /**
+     * @brief Checks whether a whole directory can be skipped
+     *
+     * Only folder rules apply, so every file below a directory for which
+     * this returns true is also excluded by isExcluded().
+     */
+    bool isDirectoryExcluded(QStringView dirPath) const;
+
+    /**
+     * @brief Number of configured (non built-in) rules
+     */
+    int ruleCount() const { return m_ruleCount; }
+
+private:
+    void addComponentRule(const QString& rule);
+    void addFileNameRule(const QString& rule);
+
+    static quint64 foldedHash(QStringView text);
+    static bool isBuiltInExcluded(QStringView fileName);
+    static bool containsRule(const QHash<quint64, QVector<QString>>& rules, QStringView text);
+    template <typename Components>
+    bool matchesFolderRules(const Components& components) const;
+
+    // Rules matching a single path component (folder names)
+    QHash<quint64, QVector<QString>> m_componentRules;
+    // Rules matching the file name only
+    QHash<quint64, QVector<QString>> m_fileNameRules;
+    // Folder rules spanning several components (e.g. "vendor/cache")
+    QVector<QStringList> m_multiComponentRules;
+    int m_ruleCount = 0;
+};
+
+#endif // EXCLUSION_MATCHER_H
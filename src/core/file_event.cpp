@@ -0,0 +1,100 @@
+#include "file_event.h"
+
+FileEvent::Kind FileEvent::merge(Kind pending, Kind incoming)
+{
+    if (incoming == Kind::Deleted) {
+        return Kind::Deleted;
+    }
+    if (pending == Kind::Deleted) {
+        // Replaced, e.g. by an editor's write-and-rename save
+        return Kind::Changed;
+    }
+    // Otherwise the pending event stands: a Created absorbs later writes
+    return pending;
+}
+
+void FileEventCoalescer::add(const QString& path, FileEvent::Kind kind)
+{
+    const auto it = m_indexByPath.constFind(path);
+    if (it == m_indexByPath.constEnd()) {
+        m_indexByPath.insert(path, m_events.size());
+        m_events.append(FileEvent{path, kind});
+        return;
+    }
+
+    ++m_merged;
+    FileEvent& pending = m_events[it.value()];
+    pending.kind = FileEvent::merge(pending.kind, kind);
+}
+
+void FileEventCoalescer::addRename(const QString& oldPath, const QString& newPath, bool isDirectory)
+{
+    // Take pending events at or below the old path out of their slots
+    const QString prefix = oldPath + QLatin1Char('/');
+    QVector<FileEvent> carried;
+    for (auto it = m_indexByPath.begin(); it != m_indexByPath.end();) {
+        const QString& path = it.key();
+        const bool moved = isDirectory ? path.startsWith(prefix) : path == oldPath;
+        if (!moved) {
+            ++it;
+            continue;
+        }
+        FileEvent& pending = m_events[it.value()];
+        carried.append(FileEvent{newPath + path.mid(oldPath.size()), pending.kind});
+        pending.path.clear();
+        it = m_indexByPath.erase(it);
+    }
+
+    // Whatever is pending for the new path happened before the rename; later
+    // events for it must land after the rename, not merge into that entry
+    m_indexByPath.remove(newPath);
+
+    FileEvent rename;
+    rename.path = newPath;
+    rename.kind = FileEvent::Kind::Renamed;
+    rename.oldPath = oldPath;
+    rename.isDirectory = isDirectory;
+    m_events.append(rename);
+
+    for (const FileEvent& event : carried) {
+        add(event.path, event.kind);
+    }
+}
+
+void FileEventCoalescer::addDirectoryRemoval(const QString& path)
+{
+    const QString prefix = path + QLatin1Char('/');
+    for (auto it = m_indexByPath.begin(); it != m_indexByPath.end();) {
+        if (!it.key().startsWith(prefix)) {
+            ++it;
+            continue;
+        }
+        m_events[it.value()].path.clear();
+        it = m_indexByPath.erase(it);
+        ++m_merged;
+    }
+
+    // Later events for the path start a new entry after the removal
+    m_indexByPath.remove(path);
+
+    FileEvent removal;
+    removal.path = path;
+    removal.kind = FileEvent::Kind::Deleted;
+    removal.isDirectory = true;
+    m_events.append(removal);
+}
+
+FileEventBatch FileEventCoalescer::take()
+{
+    FileEventBatch events;
+    events.reserve(m_events.size());
+    for (FileEvent& event : m_events) {
+        if (!event.path.isEmpty()) {
+            events.append(std::move(event));
+        }
+    }
+    m_events.clear();
+    m_indexByPath.clear();
+    m_merged = 0;
+    return events;
+}
@@ -0,0 +1,87 @@
+#ifndef FILE_EVENT_H
+#define FILE_EVENT_H
+
+#include <QHash>
+#include <QMetaType>
+#include <QString>
+#include <QVector>
+
+/**
+ * @brief One coalesced file system event
+ */
+struct FileEvent {
+    enum class Kind {
+        Changed,
+        Created,
+        // With isDirectory, the directory left the tree with everything in it
+        Deleted,
+        // path is the new location, oldPath the one it was moved from
+        Renamed
+    };
+
+    QString path;
+    Kind kind = Kind::Changed;
+    QString oldPath;
+    bool isDirectory = false;
+
+    /**
+     * @brief Kind to report when another event arrives for a pending path
+     *
+     * A file created and then written stays Created, a file deleted and
+     * created again is reported as Changed so it is compared with its
+     * baseline, and a deletion wins over anything before it.
+     */
+    static Kind merge(Kind pending, Kind incoming);
+};
+
+using FileEventBatch = QVector<FileEvent>;
+
+Q_DECLARE_METATYPE(FileEvent)
+Q_DECLARE_METATYPE(FileEventBatch)
+
+/**
+ * @brief Collapses the events of a short window into one event per path
+ *
+ * Events are kept in the order each path was first seen. Later events for
+ * a path merge into the pending one as described by FileEvent::merge(). Not thread-safe;
+ * owned by the thread that receives the raw events.
+ */
+class FileEventCoalescer {
+public:
+    FileEventCoalescer() = default;
+
+    void add(const QString& path, FileEvent::Kind kind);
+
+    bool isEmpty() const { return m_events.isEmpty(); }
+    int size() const { return m_events.size(); }
+
+    /**
+     * @brief Records a rename; pending events under the old path move to
+     * the new one and are reported after the rename
+     */
+    void addRename(const QString& oldPath, const QString& newPath, bool isDirectory);
+
+    /**
+     * @brief Records that a directory left the tree; pending events below
+     * it are dropped
+     */
+    void addDirectoryRemoval(const QString& path);
+
+    /**
+     * @brief Raw events merged away since the last take()
+     */
+    int mergedCount() const { return m_merged; }
+
+    /**
+     * @brief Returns the pending events and starts a new window
+     */
+    FileEventBatch take();
+
+private:
+    // Entries moved away by a rename are left behind with an empty path
+    FileEventBatch m_events;
+    QHash<QString, int> m_indexByPath;
+    int m_merged = 0;
+};
+
+#endif // FILE_EVENT_H
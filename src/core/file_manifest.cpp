@@ -0,0 +1,165 @@
+#include "file_manifest.h"
+#include "exclusion_matcher.h"
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+
+#ifdef Q_OS_UNIX
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#endif
+
+namespace {
+    inline bool isCancelled(const std::atomic<bool>* cancelled)
+    {
+        return cancelled && cancelled->load(std::memory_order_relaxed);
+    }
+
+    inline QString joinRelative(const QString& parent, const QString& name)
+    {
+        return parent.isEmpty() ? name : parent + QLatin1Char('/') + name;
+    }
+
+#ifdef Q_OS_UNIX
+    inline qint64 modificationTimeNs(const struct stat& st)
+    {
+#if defined(Q_OS_DARWIN)
+        return qint64(st.st_mtimespec.tv_sec) * 1000000000LL + st.st_mtimespec.tv_nsec;
+#elif defined(Q_OS_LINUX)
+        return qint64(st.st_mtim.tv_sec) * 1000000000LL + st.st_mtim.tv_nsec;
+#else
+        return qint64(st.st_mtime) * 1000000000LL;
+#endif
+    }
+#endif
+}
+
+FileManifest FileManifest::scan(const QString& root,
+                                const ExclusionMatcher& exclusions,
+                                const std::atomic<bool>* cancelled)
+{
+    FileManifest manifest;
+    manifest.m_root = QDir::cleanPath(root);
+
+#ifdef Q_OS_UNIX
+    manifest.scanNative(exclusions, cancelled);
+#else
+    manifest.scanPortable(exclusions, cancelled);
+#endif
+
+    return manifest;
+}
+
+QString FileManifest::absolutePath(const QString& relativePath) const
+{
+    return m_root + QLatin1Char('/') + relativePath;
+}
+
+#ifdef Q_OS_UNIX
+void FileManifest::scanNative(const ExclusionMatcher& exclusions, const std::atomic<bool>* cancelled)
+{
+    // Iterative walk with one fstatat() per entry: size, mtime and inode come
+    // from the same call that tells files and directories apart
+    QStringList pending;
+    pending << QString();
+
+    while (!pending.isEmpty()) {
+        if (isCancelled(cancelled)) {
+            return;
+        }
+
+        const QString relativeDir = pending.takeLast();
+        const QString absoluteDir = relativeDir.isEmpty() ? m_root : absolutePath(relativeDir);
+
+        DIR* dir = ::opendir(QFile::encodeName(absoluteDir).constData());
+        if (!dir) {
+            continue;
+        }
+        const int dirFd = ::dirfd(dir);
+
+        while (struct dirent* entry = ::readdir(dir)) {
+            // Skips ".", ".." and hidden entries, matching QDir without QDir::Hidden
+            if (entry->d_name[0] == '.') {
+                continue;
+            }
+            if (entry->d_type == DT_LNK) {
+                continue;
+            }
+
+            struct stat st;
+            if (::fstatat(dirFd, entry->d_name, &st, AT_SYMLINK_NOFOLLOW) != 0) {
+                continue;
+            }
+
+            const QString relativePath = joinRelative(relativeDir, QFile::decodeName(entry->d_name));
+
+            if (S_ISDIR(st.st_mode)) {
+                if (exclusions.isDirectoryExcluded(absolutePath(relativePath))) {
+                    continue;
+                }
+                m_directories << relativePath;
+                pending << relativePath;
+            } else if (S_ISREG(st.st_mode)) {
+                if (exclusions.isExcluded(absolutePath(relativePath))) {
+                    continue;
+                }
+
+                ManifestEntry file;
+                file.relativePath = relativePath;
+                file.size = st.st_size;
+                file.mtimeNs = modificationTimeNs(st);
+                file.inode = st.st_ino;
+                m_files.append(file);
+                m_totalBytes += file.size;
+            }
+        }
+
+        ::closedir(dir);
+    }
+}
+#endif
+
+void FileManifest::scanPortable(const ExclusionMatcher& exclusions, const std::atomic<bool>* cancelled)
+{
+    // One directory at a time so excluded subtrees can be pruned
+    QStringList pending;
+    pending << QString();
+
+    while (!pending.isEmpty()) {
+        if (isCancelled(cancelled)) {
+            return;
+        }
+
+        const QString relativeDir = pending.takeLast();
+        const QString absoluteDir = relativeDir.isEmpty() ? m_root : absolutePath(relativeDir);
+
+        QDirIterator it(absoluteDir, QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot | QDir::NoSymLinks);
+        while (it.hasNext()) {
+            const QString path = it.next();
+            const QFileInfo info = it.fileInfo();
+            const QString relativePath = joinRelative(relativeDir, info.fileName());
+
+            if (info.isDir()) {
+                if (exclusions.isDirectoryExcluded(path)) {
+                    continue;
+                }
+                m_directories << relativePath;
+                pending << relativePath;
+            } else {
+                if (exclusions.isExcluded(path)) {
+                    continue;
+                }
+
+                ManifestEntry file;
+                file.relativePath = relativePath;
+                file.size = info.size();
+                file.mtimeNs = info.lastModified().toMSecsSinceEpoch() * 1000000LL;
+                m_files.append(file);
+                m_totalBytes += file.size;
+            }
+        }
+    }
+}
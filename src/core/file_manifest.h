@@ -0,0 +1,66 @@
+#ifndef FILE_MANIFEST_H
+#define FILE_MANIFEST_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <atomic>
+
+class ExclusionMatcher;
+
+/**
+ * @brief Metadata for one file found while scanning a source tree
+ */
+struct ManifestEntry {
+    QString relativePath;
+    qint64 size = 0;
+    qint64 mtimeNs = 0;
+    quint64 inode = 0;
+};
+
+/**
+ * @brief Flat list of every watched file and directory below a source root
+ *
+ * Produced by a single walk of the tree and reused for the progress total,
+ * the baseline reader and watch registration, so the tree is not walked
+ * once per consumer. Excluded directories are pruned and never descended.
+ */
+class FileManifest {
+public:
+    FileManifest() = default;
+
+    /**
+     * @brief Walks a source tree once
+     * @param root Absolute source root
+     * @param exclusions Compiled exclusion rules for the system
+     * @param cancelled Optional flag polled during the walk
+     */
+    static FileManifest scan(const QString& root,
+                             const ExclusionMatcher& exclusions,
+                             const std::atomic<bool>* cancelled = nullptr);
+
+    const QString& root() const { return m_root; }
+    const QVector<ManifestEntry>& files() const { return m_files; }
+    const QStringList& directories() const { return m_directories; }
+
+    int fileCount() const { return m_files.size(); }
+    qint64 totalBytes() const { return m_totalBytes; }
+
+    /**
+     * @brief Resolves a root-relative path against the source root
+     */
+    QString absolutePath(const QString& relativePath) const;
+
+private:
+#ifdef Q_OS_UNIX
+    void scanNative(const ExclusionMatcher& exclusions, const std::atomic<bool>* cancelled);
+#endif
+    void scanPortable(const ExclusionMatcher& exclusions, const std::atomic<bool>* cancelled);
+
+    QString m_root;
+    QVector<ManifestEntry> m_files;
+    QStringList m_directories;
+    qint64 m_totalBytes = 0;
+};
+
+#endif // FILE_MANIFEST_H
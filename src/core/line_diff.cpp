@@ -0,0 +1,414 @@
+#include "line_diff.h"
+#include "line_interner.h"
+#include <vector>
+
+namespace {
+    // Half-open line ranges of both texts still to be diffed
+    struct Range {
+        int oldBegin = 0;
+        int oldEnd = 0;
+        int newBegin = 0;
+        int newEnd = 0;
+        bool histogram = false;
+    };
+
+    // Where two differing texts stop sharing whole lines
+    struct TextTrim {
+        // Offset of the first differing line, the same in both texts
+        qsizetype start = 0;
+        // Offset of the newline ending the last differing line, or the
+        // text size if no whole line is shared at the end
+        qsizetype oldStop = 0;
+        qsizetype newStop = 0;
+        int prefixLines = 0;
+    };
+
+    // Common leading and trailing lines are found on the raw text, so a
+    // small edit to a large file hardly costs any tokenizing. Only whole
+    // lines count: the prefix ends at the last newline before the first
+    // difference, the suffix starts at the first newline after the last.
+    TextTrim trimCommonLines(QStringView oldText, QStringView newText)
+    {
+        TextTrim trim;
+        const qsizetype limit = qMin(oldText.size(), newText.size());
+        qsizetype same = 0;
+        while (same < limit && oldText[same] == newText[same]) {
+            ++same;
+        }
+        trim.start = same == 0 ? 0 : oldText.lastIndexOf(QLatin1Char('\n'), same - 1) + 1;
+        trim.prefixLines = int(oldText.left(trim.start).count(QLatin1Char('\n')));
+
+        // The suffix may not reach back into the prefix
+        const qsizetype tailLimit = limit - trim.start;
+        qsizetype tail = 0;
+        while (tail < tailLimit
+               && oldText[oldText.size() - 1 - tail] == newText[newText.size() - 1 - tail]) {
+            ++tail;
+        }
+        trim.oldStop = oldText.size();
+        trim.newStop = newText.size();
+        if (tail > 0) {
+            const qsizetype newline = oldText.indexOf(QLatin1Char('\n'), oldText.size() - tail);
+            if (newline >= 0) {
+                trim.newStop = newText.size() - (oldText.size() - newline);
+                trim.oldStop = newline;
+            }
+        }
+        return trim;
+    }
+
+    /**
+     * Marks every line of both sequences as kept or changed. Lines are
+     * interned ids below idCount, so comparing two is an integer compare
+     * and per-line tables are plain arrays.
+     */
+    class DiffRunner {
+    public:
+        DiffRunner(const quint32* oldIds, int oldSize, const quint32* newIds, int newSize, int idCount,
+                   const std::atomic<bool>* cancelled)
+            : m_old(oldIds),
+              m_new(newIds),
+              m_idCount(idCount),
+              m_cancelled(cancelled),
+              m_oldChanged(size_t(oldSize), false),
+              m_newChanged(size_t(newSize), false)
+        {
+        }
+
+        void run(bool histogram)
+        {
+            std::vector<Range> work;
+            work.push_back({0, int(m_oldChanged.size()), 0, int(m_newChanged.size()), histogram});
+
+            while (!work.empty() && !isCancelled()) {
+                Range range = work.back();
+                work.pop_back();
+
+                // Common leading and trailing lines are kept as they are
+                while (range.oldBegin < range.oldEnd && range.newBegin < range.newEnd
+                       && m_old[range.oldBegin] == m_new[range.newBegin]) {
+                    ++range.oldBegin;
+                    ++range.newBegin;
+                }
+                while (range.oldBegin < range.oldEnd && range.newBegin < range.newEnd
+                       && m_old[range.oldEnd - 1] == m_new[range.newEnd - 1]) {
+                    --range.oldEnd;
+                    --range.newEnd;
+                }
+
+                if (range.oldBegin == range.oldEnd || range.newBegin == range.newEnd) {
+                    markChanged(range);
+                } else if (!range.histogram || !splitHistogram(range, &work)) {
+                    splitMyers(range, &work);
+                }
+            }
+        }
+
+        QVector<DiffHunk> hunks() const
+        {
+            QVector<DiffHunk> result;
+            const int oldSize = int(m_oldChanged.size());
+            const int newSize = int(m_newChanged.size());
+            int oldIndex = 0;
+            int newIndex = 0;
+            while (oldIndex < oldSize || newIndex < newSize) {
+                if (oldIndex < oldSize && newIndex < newSize
+                    && !m_oldChanged[size_t(oldIndex)] && !m_newChanged[size_t(newIndex)]) {
+                    ++oldIndex;
+                    ++newIndex;
+                    continue;
+                }
+
+                DiffHunk hunk;
+                hunk.oldStart = oldIndex;
+                hunk.newStart = newIndex;
+                while (oldIndex < oldSize && m_oldChanged[size_t(oldIndex)]) {
+                    ++oldIndex;
+                }
+                while (newIndex < newSize && m_newChanged[size_t(newIndex)]) {
+                    ++newIndex;
+                }
+                hunk.oldCount = oldIndex - hunk.oldStart;
+                hunk.newCount = newIndex - hunk.newStart;
+                result.append(hunk);
+            }
+            return result;
+        }
+
+        bool isCancelled() const
+        {
+            return m_cancelled && m_cancelled->load(std::memory_order_relaxed);
+        }
+
+    private:
+        void markChanged(const Range& range)
+        {
+            for (int i = range.oldBegin; i < range.oldEnd; ++i) {
+                m_oldChanged[size_t(i)] = true;
+            }
+            for (int j = range.newBegin; j < range.newEnd; ++j) {
+                m_newChanged[size_t(j)] = true;
+            }
+        }
+
+        // Splits range around its best anchor; false if it has none
+        bool splitHistogram(const Range& range, std::vector<Range>* work)
+        {
+            if (m_head.empty()) {
+                m_head.assign(size_t(m_idCount), -1);
+                m_count.assign(size_t(m_idCount), 0);
+                m_nextSame.assign(m_oldChanged.size(), -1);
+            }
+
+            // Chain the old positions of each line id, in ascending order
+            for (int i = range.oldEnd - 1; i >= range.oldBegin; --i) {
+                const quint32 id = m_old[i];
+                m_nextSame[size_t(i)] = m_head[id];
+                m_head[id] = i;
+                ++m_count[id];
+            }
+
+            bool anyCommon = false;
+            int bestCount = DiffConfig::MAX_HISTOGRAM_CHAIN;
+            int bestLength = 0;
+            int bestOld = -1;
+            int bestNew = -1;
+            for (int j = range.newBegin; j < range.newEnd;) {
+                const int count = m_count[m_new[j]];
+                if (count == 0) {
+                    ++j;
+                    continue;
+                }
+                anyCommon = true;
+                if (count > bestCount) {
+                    ++j;
+                    continue;
+                }
+
+                // Extend each occurrence to its full matching run; rarer
+                // anchors win, then longer runs
+                int next = j + 1;
+                for (int i = m_head[m_new[j]]; i >= 0; i = m_nextSame[size_t(i)]) {
+                    int oldStart = i;
+                    int newStart = j;
+                    while (oldStart > range.oldBegin && newStart > range.newBegin
+                           && m_old[oldStart - 1] == m_new[newStart - 1]) {
+                        --oldStart;
+                        --newStart;
+                    }
+                    int oldStop = i + 1;
+                    int newStop = j + 1;
+                    while (oldStop < range.oldEnd && newStop < range.newEnd
+                           && m_old[oldStop] == m_new[newStop]) {
+                        ++oldStop;
+                        ++newStop;
+                    }
+
+                    const int length = oldStop - oldStart;
+                    if (count < bestCount || length > bestLength) {
+                        bestCount = count;
+                        bestLength = length;
+                        bestOld = oldStart;
+                        bestNew = newStart;
+                    }
+                    next = qMax(next, newStop);
+                }
+                j = next;
+            }
+
+            // Leave the tables clean for the next region
+            for (int i = range.oldBegin; i < range.oldEnd; ++i) {
+                m_head[m_old[i]] = -1;
+                m_count[m_old[i]] = 0;
+            }
+
+            if (!anyCommon) {
+                // Nothing in common, Myers would only confirm that slowly
+                markChanged(range);
+                return true;
+            }
+            if (bestOld < 0) {
+                return false;
+            }
+
+            work->push_back({range.oldBegin, bestOld, range.newBegin, bestNew, true});
+            work->push_back({bestOld + bestLength, range.oldEnd, bestNew + bestLength, range.newEnd, true});
+            return true;
+        }
+
+        void splitMyers(const Range& range, std::vector<Range>* work)
+        {
+            int oldSplit = 0;
+            int newSplit = 0;
+            if (!findMiddleSnake(range, &oldSplit, &newSplit)) {
+                markChanged(range);
+                return;
+            }
+
+            oldSplit += range.oldBegin;
+            newSplit += range.newBegin;
+            work->push_back({range.oldBegin, oldSplit, range.newBegin, newSplit, false});
+            work->push_back({oldSplit, range.oldEnd, newSplit, range.newEnd, false});
+        }
+
+        // Searches forward from the start and backward from the end of a
+        // trimmed range until the paths overlap; the overlap splits the
+        // range into two halves of a minimal edit script. Coordinates are
+        // relative to the range.
+        bool findMiddleSnake(const Range& range, int* oldSplit, int* newSplit)
+        {
+            const quint32* a = m_old + range.oldBegin;
+            const quint32* b = m_new + range.newBegin;
+            const int n = range.oldEnd - range.oldBegin;
+            const int m = range.newEnd - range.newBegin;
+            const int maxD = qMin((n + m + 1) / 2, DiffConfig::MAX_EDIT_DISTANCE);
+            const int offset = maxD + 1;
+            const int length = 2 * offset + 1;
+
+            // Furthest x reached on each diagonal k = x - y, -1 if none yet;
+            // the backward search measures x from the end
+            m_forward.assign(size_t(length), -1);
+            m_backward.assign(size_t(length), -1);
+            m_forward[size_t(offset + 1)] = 0;
+            m_backward[size_t(offset + 1)] = 0;
+
+            const int delta = n - m;
+            // With an odd delta the paths meet during a forward step
+            const bool front = (delta & 1) != 0;
+            // Diagonals that ran off the edge are skipped from then on
+            int k1Start = 0;
+            int k1End = 0;
+            int k2Start = 0;
+            int k2End = 0;
+
+            for (int d = 0; d < maxD; ++d) {
+                if (isCancelled()) {
+                    return false;
+                }
+
+                for (int k1 = -d + k1Start; k1 <= d - k1End; k1 += 2) {
+                    const int k1Offset = offset + k1;
+                    int x1 = (k1 == -d || (k1 != d && m_forward[size_t(k1Offset - 1)] < m_forward[size_t(k1Offset + 1)]))
+                        ? m_forward[size_t(k1Offset + 1)]
+                        : m_forward[size_t(k1Offset - 1)] + 1;
+                    int y1 = x1 - k1;
+                    while (x1 < n && y1 < m && a[x1] == b[y1]) {
+                        ++x1;
+                        ++y1;
+                    }
+                    m_forward[size_t(k1Offset)] = x1;
+
+                    if (x1 > n) {
+                        k1End += 2;
+                    } else if (y1 > m) {
+                        k1Start += 2;
+                    } else if (front) {
+                        const int k2Offset = offset + delta - k1;
+                        if (k2Offset >= 0 && k2Offset < length && m_backward[size_t(k2Offset)] != -1
+                            && x1 >= n - m_backward[size_t(k2Offset)]) {
+                            *oldSplit = x1;
+                            *newSplit = y1;
+                            return true;
+                        }
+                    }
+                }
+
+                for (int k2 = -d + k2Start; k2 <= d - k2End; k2 += 2) {
+                    const int k2Offset = offset + k2;
+                    int x2 = (k2 == -d || (k2 != d && m_backward[size_t(k2Offset - 1)] < m_backward[size_t(k2Offset + 1)]))
+                        ? m_backward[size_t(k2Offset + 1)]
+                        : m_backward[size_t(k2Offset - 1)] + 1;
+                    int y2 = x2 - k2;
+                    while (x2 < n && y2 < m && a[n - x2 - 1] == b[m - y2 - 1]) {
+                        ++x2;
+                        ++y2;
+                    }
+                    m_backward[size_t(k2Offset)] = x2;
+
+                    if (x2 > n) {
+                        k2End += 2;
+                    } else if (y2 > m) {
+                        k2Start += 2;
+                    } else if (!front) {
+                        const int k1Offset = offset + delta - k2;
+                        if (k1Offset >= 0 && k1Offset < length && m_forward[size_t(k1Offset)] != -1) {
+                            const int x1 = m_forward[size_t(k1Offset)];
+                            const int y1 = offset + x1 - k1Offset;
+                            if (x1 >= n - x2) {
+                                *oldSplit = x1;
+                                *newSplit = y1;
+                                return true;
+                            }
+                        }
+                    }
+                }
+            }
+
+            return false;
+        }
+
+        const quint32* m_old;
+        const quint32* m_new;
+        int m_idCount;
+        const std::atomic<bool>* m_cancelled;
+        std::vector<bool> m_oldChanged;
+        std::vector<bool> m_newChanged;
+        // Diagonal vectors, reused across regions
+        std::vector<int> m_forward;
+        std::vector<int> m_backward;
+        // Histogram tables: first old position and occurrence count per
+        // line id, and the next position with the same id per old line
+        std::vector<int> m_head;
+        std::vector<int> m_count;
+        std::vector<int> m_nextSame;
+    };
+}
+
+QVector<DiffHunk> LineDiff::compute(QStringView oldText, QStringView newText, Algorithm algorithm,
+                                    const std::atomic<bool>* cancelled)
+{
+    if (oldText == newText) {
+        return QVector<DiffHunk>();
+    }
+
+    const TextTrim trim = trimCommonLines(oldText, newText);
+
+    LineInterner interner;
+    QVector<quint32> oldIds;
+    QVector<quint32> newIds;
+    interner.tokenize(oldText.mid(trim.start, trim.oldStop - trim.start), &oldIds);
+    interner.tokenize(newText.mid(trim.start, trim.newStop - trim.start), &newIds);
+
+    QVector<DiffHunk> hunks = compute(oldIds, newIds, interner.size(), algorithm, cancelled);
+    for (DiffHunk& hunk : hunks) {
+        hunk.oldStart += trim.prefixLines;
+        hunk.newStart += trim.prefixLines;
+    }
+    return hunks;
+}
+
+void LineDiff::commonLines(QStringView oldText, QStringView newText, int* prefixLines, int* suffixLines)
+{
+    if (oldText == newText) {
+        *prefixLines = int(oldText.count(QLatin1Char('\n'))) + 1;
+        *suffixLines = 0;
+        return;
+    }
+
+    const TextTrim trim = trimCommonLines(oldText, newText);
+    *prefixLines = trim.prefixLines;
+    // Every newline from the cut on starts a shared trailing line
+    *suffixLines = int(oldText.mid(trim.oldStop).count(QLatin1Char('\n')));
+}
+
+QVector<DiffHunk> LineDiff::compute(const QVector<quint32>& oldIds, const QVector<quint32>& newIds,
+                                    int idCount, Algorithm algorithm, const std::atomic<bool>* cancelled)
+{
+    DiffRunner runner(oldIds.constData(), int(oldIds.size()),
+                      newIds.constData(), int(newIds.size()), idCount, cancelled);
+    runner.run(algorithm == Algorithm::Histogram);
+    if (runner.isCancelled()) {
+        return QVector<DiffHunk>();
+    }
+    return runner.hunks();
+}
@@ -0,0 +1,90 @@
+#ifndef LINE_DIFF_H
+#define LINE_DIFF_H
+
+#include <QStringView>
+#include <QVector>
+#include <atomic>
+
+// Configuration constants
+namespace DiffConfig {
+    // Lines occurring more often than this in a region are not used as
+    // histogram anchors; a region without anchors is handed to Myers
+    constexpr int MAX_HISTOGRAM_CHAIN = 64;
+    // Myers gives up on a region after this many edits in either direction
+    // and reports it as replaced as a whole, bounding pathological inputs
+    constexpr int MAX_EDIT_DISTANCE = 4096;
+}
+
+/**
+ * @brief A run of lines that differs between two texts
+ *
+ * oldCount lines at oldStart were replaced by newCount lines at newStart
+ * (0-based line numbers). A count of 0 is a pure insertion or deletion.
+ * Between consecutive hunks the two texts match line for line.
+ */
+struct DiffHunk {
+    int oldStart = 0;
+    int oldCount = 0;
+    int newStart = 0;
+    int newCount = 0;
+};
+
+/**
+ * @brief Line-based diff of two texts
+ *
+ * Myers mode finds a minimal edit script in O(ND) time using the
+ * linear-space divide-and-conquer refinement: each region is split at the
+ * middle snake, found by searching from both ends at once, and the halves
+ * are diffed in turn. Histogram mode (the default, as in git) first anchors
+ * each region on its rarest common line, extended to the longest matching
+ * run, and diffs both sides of the anchor the same way; regions without a
+ * usable anchor fall back to Myers. Its output follows the structure of
+ * the code, e.g. keeping a moved function whole instead of matching its
+ * braces and blank lines against other ones.
+ *
+ * Lines are interned first (see LineInterner), so the algorithms compare
+ * integer ids and index plain arrays instead of hashing and comparing
+ * strings. Common leading and trailing lines are cut off the raw text
+ * before tokenizing, and again off every region before either algorithm
+ * runs. Work is kept on an explicit stack, so deep splits cannot overflow
+ * the call stack. A diff can be cancelled from another thread through an
+ * optional flag, which is polled between regions and between Myers steps.
+ */
+class LineDiff {
+public:
+    enum class Algorithm {
+        Myers,
+        Histogram
+    };
+
+    /**
+     * @brief Computes the hunks turning oldText into newText
+     *
+     * Lines are numbered as in QString::split('\n').
+     * @param cancelled Optional flag that abandons the diff once set
+     * @return Hunks in ascending order; empty if the texts are equal or the
+     *         diff was cancelled
+     */
+    static QVector<DiffHunk> compute(QStringView oldText, QStringView newText,
+                                     Algorithm algorithm = Algorithm::Histogram,
+                                     const std::atomic<bool>* cancelled = nullptr);
+
+    /**
+     * @brief Counts the whole lines two texts share at their start and end
+     *
+     * Cheap enough to run on every edit of a live file: one pass over the
+     * characters, no tokenizing. The two runs never overlap; for differing
+     * texts at least one line of each lies between them.
+     */
+    static void commonLines(QStringView oldText, QStringView newText, int* prefixLines, int* suffixLines);
+
+    /**
+     * @brief Computes the hunks between two sequences of interned line ids
+     * @param idCount Upper bound (exclusive) of the ids in both sequences
+     */
+    static QVector<DiffHunk> compute(const QVector<quint32>& oldIds, const QVector<quint32>& newIds,
+                                     int idCount, Algorithm algorithm = Algorithm::Histogram,
+                                     const std::atomic<bool>* cancelled = nullptr);
+};
+
+#endif // LINE_DIFF_H
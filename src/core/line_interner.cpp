@@ -0,0 +1,73 @@
+#include "line_interner.h"
+#include <QHash>
+
+namespace {
+    constexpr size_t INITIAL_SLOTS = 1024;
+}
+
+void LineInterner::tokenize(QStringView text, QVector<quint32>* ids)
+{
+    qsizetype start = 0;
+    for (;;) {
+        const qsizetype end = text.indexOf(QLatin1Char('\n'), start);
+        if (end < 0) {
+            ids->append(intern(text.mid(start)));
+            return;
+        }
+        ids->append(intern(text.mid(start, end - start)));
+        start = end + 1;
+    }
+}
+
+quint32 LineInterner::intern(QStringView line)
+{
+    // Keep the load factor at or below one half
+    if ((m_entries.size() + 1) * 2 > m_slots.size()) {
+        grow();
+    }
+
+    const size_t hash = qHash(line);
+    const size_t mask = m_slots.size() - 1;
+    for (size_t slot = hash & mask;; slot = (slot + 1) & mask) {
+        const quint32 stored = m_slots[slot];
+        if (stored == 0) {
+            const quint32 id = quint32(m_entries.size());
+            Entry entry;
+            entry.offset = m_arena.size();
+            entry.length = line.size();
+            entry.hash = hash;
+            m_arena.append(line);
+            m_entries.push_back(entry);
+            m_slots[slot] = id + 1;
+            return id;
+        }
+
+        const Entry& entry = m_entries[stored - 1];
+        if (entry.hash == hash && entry.length == line.size()
+            && QStringView(m_arena).mid(entry.offset, entry.length) == line) {
+            return stored - 1;
+        }
+    }
+}
+
+QStringView LineInterner::line(quint32 id) const
+{
+    const Entry& entry = m_entries[id];
+    return QStringView(m_arena).mid(entry.offset, entry.length);
+}
+
+void LineInterner::grow()
+{
+    const size_t slotCount = m_slots.empty() ? INITIAL_SLOTS : m_slots.size() * 2;
+    m_slots.assign(slotCount, 0);
+
+    // Stored hashes make rehashing free of character access
+    const size_t mask = slotCount - 1;
+    for (size_t id = 0; id < m_entries.size(); ++id) {
+        size_t slot = m_entries[id].hash & mask;
+        while (m_slots[slot] != 0) {
+            slot = (slot + 1) & mask;
+        }
+        m_slots[slot] = quint32(id + 1);
+    }
+}
@@ -0,0 +1,56 @@
+#ifndef LINE_INTERNER_H
+#define LINE_INTERNER_H
+
+#include <QString>
+#include <QStringView>
+#include <QVector>
+#include <vector>
+
+/**
+ * @brief Maps text lines to dense integer ids, equal lines to equal ids
+ *
+ * Each distinct line is hashed once and its characters are copied once
+ * into a single arena string, so identical lines of the old and new side
+ * share storage and later comparisons are integer compares. Lookup is an
+ * open-addressing table of ids that compares the stored hash before
+ * touching characters. Ids run from 0 to size() - 1. Not thread-safe.
+ */
+class LineInterner {
+public:
+    LineInterner() = default;
+
+    /**
+     * @brief Splits text at '\n' (as QString::split('\n') would) and appends
+     * the id of each line to ids
+     */
+    void tokenize(QStringView text, QVector<quint32>* ids);
+
+    /**
+     * @brief Id of line, adding it if it is new
+     */
+    quint32 intern(QStringView line);
+
+    /**
+     * @brief Text of an interned line; valid until the next intern()
+     */
+    QStringView line(quint32 id) const;
+
+    int size() const { return int(m_entries.size()); }
+
+private:
+    struct Entry {
+        qsizetype offset = 0;
+        qsizetype length = 0;
+        size_t hash = 0;
+    };
+
+    void grow();
+
+    // Characters of all distinct lines, back to back
+    QString m_arena;
+    std::vector<Entry> m_entries;
+    // id + 1 per slot, 0 for an empty slot; size is a power of two
+    std::vector<quint32> m_slots;
+};
+
+#endif // LINE_INTERNER_H
@@ -1,4 +1,5 @@
 #include "models.h"
+#include "line_diff.h"
 #include <QFileInfo>
 
 FileChangeEntry::FileChangeEntry(const QString& filePath,
@@ -36,27 +37,25 @@ QVector<QString> FileChangeEntry::getDiffLines() const
             diffLines.append("- " + line);
         }
     } else {
-        // File was modified - compute unified diff
-        QStringList oldLines = m_oldContent.split('\n');
-        QStringList newLines = m_newContent.split('\n');
-        
-        // Simple diff: mark lines as added/removed/context
-        // For a more sophisticated diff algorithm, consider using a library
-        int maxLines = qMax(oldLines.size(), newLines.size());
-        for (int i = 0; i < maxLines; ++i) {
-            QString oldLine = i < oldLines.size() ? oldLines[i] : "";
-            QString newLine = i < newLines.size() ? newLines[i] : "";
-            
-            if (oldLine == newLine) {
-                diffLines.append("  " + oldLine); // Context line
-            } else {
-                if (!oldLine.isEmpty()) {
-                    diffLines.append("- " + oldLine);
-                }
-                if (!newLine.isEmpty()) {
-                    diffLines.append("+ " + newLine);
-                }
+        // File was modified - unchanged lines as context around each hunk
+        const QVector<DiffHunk> hunks = LineDiff::compute(m_oldContent, m_newContent);
+        const QStringList oldLines = m_oldContent.split('\n');
+        const QStringList newLines = m_newContent.split('\n');
+
+        int oldIdx = 0;
+        for (const DiffHunk& hunk : hunks) {
+            while (oldIdx < hunk.oldStart) {
+                diffLines.append("  " + oldLines[oldIdx++]); // Context line
+            }
+            for (int i = 0; i < hunk.oldCount; ++i) {
+                diffLines.append("- " + oldLines[oldIdx++]);
             }
+            for (int i = 0; i < hunk.newCount; ++i) {
+                diffLines.append("+ " + newLines[hunk.newStart + i]);
+            }
+        }
+        while (oldIdx < oldLines.size()) {
+            diffLines.append("  " + oldLines[oldIdx++]);
         }
     }
     
@@ -1,13 +1,17 @@
 #include "main_window.h"
 #include "config.h"
-#include "services/file_watcher.h"
+#include "services/watcher_service.h"
 #include "services/telegram_service.h"
+#include "services/baseline_loader.h"
 #include "ui/dialogs/log_dialog.h"
 #include "ui/dialogs/settings_dialog.h"
 #include "ui/dialogs/file_diff_dialog.h"
 #include "ui/dialogs/change_review_dialog.h"
 #include "ui/widgets/file_watcher_table.h"
 #include "ui/styles.h"
+#include "core/baseline_snapshot.h"
+#include "utils/content_hash.h"
+#include "utils/mapped_file.h"
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QPushButton>
@@ -22,7 +26,6 @@
 #include <QCloseEvent>
 #include <QMessageBox>
 #include <QScrollArea>
-#include <QDirIterator>
 #include <QFile>
 #include <QDateTime>
 #include <QInputDialog>
@@ -32,6 +35,40 @@
 #include <QProgressDialog>
 #include <QCoreApplication>
 #include <QTimer>
+#include <QProcess>
+#include <QFutureWatcher>
+#include <QtConcurrent/QtConcurrent>
+
+namespace {
+    // Upper bound for recovering one baseline file with "git show"
+    constexpr int GIT_SHOW_TIMEOUT_MS = 5000;
+
+    // Files above this size are tracked by size + hash only (0 = no cap)
+    inline qint64 maxBaselineContentBytes()
+    {
+        return qint64(AppConfig::instance().baselineMaxFileSizeMb()) * 1024 * 1024;
+    }
+
+    // Fingerprints a file from its raw bytes, the same way the baseline
+    // capture and the change check see it, and keeps its content unless it
+    // is above the size cap
+    bool readBaselineEntry(const QString& filePath, BaselineEntry* entry)
+    {
+        const qint64 maxContentBytes = maxBaselineContentBytes();
+        MappedFile file(filePath, maxContentBytes);
+        QByteArray data;
+        bool ok = false;
+        entry->hash = file.fingerprint(maxContentBytes, &data, &ok);
+        if (!ok) {
+            return false;
+        }
+        entry->size = file.size();
+        if (!data.isNull()) {
+            entry->content = BlobStore::instance().intern(data, entry->hash);
+        }
+        return true;
+    }
+}
 
 FileWatcherApp::FileWatcherApp(QWidget* parent)
     : QMainWindow(parent),
@@ -48,7 +85,8 @@ FileWatcherApp::FileWatcherApp(QWidget* parent)
       m_diffDialog(std::make_unique<FileDiffDialog>(this)),
       m_changeReviewDialog(std::make_unique<ChangeReviewDialog>(this)),
       m_notificationsEnabled(false),
-      m_isWatching(false)
+      m_isWatching(false),
+      m_recoveryWatcher(new QFutureWatcher<BaselineRecovery>(this))
 {
     setWindowTitle("Compare Observer");
     setGeometry(100, 100, 1200, 700);
@@ -246,6 +284,12 @@ void FileWatcherApp::connectSignals()
     
     // Connect diff dialog log messages to main log dialog
     connect(m_diffDialog.get(), &FileDiffDialog::logMessage, m_logDialog.get(), &LogDialog::addLog);
+
+    // Recovered baseline content is applied on the GUI thread as it comes in
+    connect(m_recoveryWatcher, &QFutureWatcher<BaselineRecovery>::resultsReadyAt,
+            this, &FileWatcherApp::applyBaselineRecoveries);
+    connect(m_recoveryWatcher, &QFutureWatcher<BaselineRecovery>::finished,
+            this, &FileWatcherApp::startBaselineRecovery);
 }
 
 void FileWatcherApp::loadSettings()
@@ -267,6 +311,7 @@ void FileWatcherApp::loadSettings()
         data.git = settings.value("git").toString();
         data.backup = settings.value("backup").toString();
         data.assign = settings.value("assign").toString();
+        data.watchMode = settings.value("watchMode", "native").toString();
         m_systemConfigs.append(data);
     }
     settings.endArray();
@@ -329,6 +374,7 @@ void FileWatcherApp::loadSettings()
     m_settingsDialog->setTelegramToken(m_telegramToken);
     m_settingsDialog->setTelegramChatId(m_telegramChatId);
     m_settingsDialog->setNotificationsEnabled(m_notificationsEnabled);
+    m_settingsDialog->setHashOnlyBaseline(AppConfig::instance().hashOnlyBaseline());
     m_settingsDialog->setSystemConfigs(m_systemConfigs);
 
     bool needRemoteWithout = m_withoutRules.isEmpty();
@@ -409,6 +455,7 @@ void FileWatcherApp::saveSettings()
         settings.setValue("git", m_systemConfigs[i].git);
         settings.setValue("backup", m_systemConfigs[i].backup);
         settings.setValue("assign", m_systemConfigs[i].assign);
+        settings.setValue("watchMode", m_systemConfigs[i].watchMode);
     }
     settings.endArray();
     
@@ -553,7 +600,6 @@ void FileWatcherApp::buildSystemPanel(int index, const SettingsDialog::SystemCon
         handleAssignToRequested(systemIndex);
     });
 
-    panel.watcher = nullptr;
     m_systemPanels.append(panel);
     m_panelLayout->addWidget(panel.container);
 }
@@ -589,16 +635,102 @@ QStringList FileWatcherApp::ruleListForSystem(const QVector<QStringList>& rows,
 
 void FileWatcherApp::stopAllWatchers()
 {
-    for (int i = 0; i < m_systemPanels.size(); ++i) {
-        auto& panel = m_systemPanels[i];
-        if (panel.watcher) {
-            m_logDialog->addLog(QString("Stopping %1 watcher...").arg(getSystemName(i)));
-            panel.watcher->stop();
-            m_logDialog->addLog(QString("%1 watcher stopped").arg(getSystemName(i)));
-            panel.watcher->deleteLater();
-            panel.watcher = nullptr;
+    // Abort any baseline capture still running in the background
+    for (BaselineLoader* loader : findChildren<BaselineLoader*>()) {
+        loader->cancel();
+    }
+
+    if (m_watcherService) {
+        m_logDialog->addLog("Stopping watcher service...");
+        m_watcherService->stop();
+        m_logDialog->addLog("Watcher service stopped");
+        m_watcherService->deleteLater();
+        m_watcherService = nullptr;
+    }
+
+    for (auto& panel : m_systemPanels) {
+        panel.watching = false;
+    }
+
+    // No more events for an open live diff; it checks the file itself
+    m_diffDialog->setWatched(false);
+}
+
+void FileWatcherApp::handleFileEvents(int systemIndex, const FileEventBatch& events)
+{
+    if (systemIndex < 0 || systemIndex >= m_systemPanels.size() || events.isEmpty()) {
+        return;
+    }
+
+    // One pass over the batch with repaints and log scrolling held back
+    // until the end, so mass changes don't stall the UI row by row
+    FileWatcherTable* table = m_systemPanels[systemIndex].table;
+    if (table) {
+        table->setUpdatesEnabled(false);
+    }
+    m_logDialog->beginBatch();
+    m_eventLogSummary = EventLogSummary();
+    m_eventLogSummary.active = events.size() > EventLogConfig::MAX_DETAILED_EVENTS;
+
+    // The open live diff follows its file through the same events instead
+    // of reading it on a timer
+    const bool diffOpen = systemIndex == m_diffSystemIndex && m_diffDialog->isVisible();
+    bool diffChanged = false;
+
+    for (const FileEvent& event : events) {
+        const QString& livePath = m_diffDialog->liveFilePath();
+        if (diffOpen && (event.path == livePath || event.oldPath == livePath
+                         || (event.isDirectory && livePath.startsWith(event.path + QLatin1Char('/'))))) {
+            diffChanged = true;
+        }
+
+        switch (event.kind) {
+            case FileEvent::Kind::Changed:
+                handleFileChanged(systemIndex, event.path);
+                break;
+            case FileEvent::Kind::Created:
+                handleFileCreated(systemIndex, event.path);
+                break;
+            case FileEvent::Kind::Deleted:
+                if (event.isDirectory) {
+                    handleDirectoryRemoved(systemIndex, event.path);
+                } else {
+                    handleFileDeleted(systemIndex, event.path);
+                }
+                break;
+            case FileEvent::Kind::Renamed:
+                handleFileRenamed(systemIndex, event.oldPath, event.path, event.isDirectory);
+                break;
         }
     }
+
+    if (m_eventLogSummary.active) {
+        const EventLogSummary& summary = m_eventLogSummary;
+        m_logDialog->addLog(QString("%1: Processed %2 events - %3 modified, %4 created, %5 deleted, "
+                                    "%6 renamed, %7 unchanged, %8 unreadable")
+            .arg(getSystemName(systemIndex)).arg(events.size())
+            .arg(summary.modified).arg(summary.created).arg(summary.deleted)
+            .arg(summary.renamed).arg(summary.unchanged).arg(summary.failed));
+        m_eventLogSummary.active = false;
+    }
+
+    m_logDialog->endBatch();
+    if (table) {
+        table->setUpdatesEnabled(true);
+    }
+
+    if (diffChanged) {
+        m_diffDialog->notifyFileChanged();
+    }
+}
+
+void FileWatcherApp::logFileEvent(int* summaryCount, const QString& message)
+{
+    if (!m_eventLogSummary.active) {
+        m_logDialog->addLog(message);
+    } else if (summaryCount) {
+        ++*summaryCount;
+    }
 }
 
 void FileWatcherApp::handleFileChanged(int systemIndex, const QString& filePath)
@@ -608,10 +740,14 @@ void FileWatcherApp::handleFileChanged(int systemIndex, const QString& filePath)
     }
 
     auto& panel = m_systemPanels[systemIndex];
+    if (panel.capturingBaseline) {
+        panel.deferredChanges << filePath;
+        return;
+    }
     const QString sourceRoot = m_systemConfigs.value(systemIndex).source;
     const QString relative = QDir(sourceRoot).relativeFilePath(filePath);
     
-    m_logDialog->addLog(QString("%1: Processing change event for %2").arg(getSystemName(systemIndex)).arg(relative));
+    logFileEvent(nullptr, QString("%1: Processing change event for %2").arg(getSystemName(systemIndex)).arg(relative));
     
     if (!panel.table) {
         return;
@@ -620,48 +756,73 @@ void FileWatcherApp::handleFileChanged(int systemIndex, const QString& filePath)
     // Check if file still exists
     QFileInfo fileInfo(filePath);
     if (!fileInfo.exists()) {
-        m_logDialog->addLog(QString("%1: File disappeared during change - %2")
+        logFileEvent(&m_eventLogSummary.failed, QString("%1: File disappeared during change - %2")
             .arg(getSystemName(systemIndex)).arg(relative));
         return;
     }
 
-    // Read NEW content from disk
-    QString newContent = readFileContent(filePath);
-    if (newContent.isNull()) {
-        m_logDialog->addLog(QString("%1: Failed to read file - %2")
-            .arg(getSystemName(systemIndex)).arg(filePath));
-        return;
-    }
+    const qint64 maxContentBytes = maxBaselineContentBytes();
 
-    // Get OLD content from baseline (stored when watching started)
-    QString oldContent = panel.table->getFileContent(relative);
+    // Get OLD fingerprint from baseline (stored when watching started)
+    const BaselineEntry* baseline = panel.table->baseline().find(relative);
 
-    // CRITICAL FIX: Check if we have a baseline for this file
-    bool hasBaseline = !oldContent.isNull();
-
-    if (!hasBaseline) {
-        // This is a newly created file (no baseline exists)
-        panel.table->setFileContent(relative, newContent);
+    if (!baseline) {
+        // This is a newly created file (no baseline exists); fingerprint it
+        // straight from the mapped file, without decoding it
+        BaselineEntry entry;
+        if (!readBaselineEntry(filePath, &entry)) {
+            logFileEvent(&m_eventLogSummary.failed, QString("%1: Failed to read file - %2")
+                .arg(getSystemName(systemIndex)).arg(filePath));
+            return;
+        }
+        panel.table->baseline().insert(relative, entry);
         panel.table->addFileEntry(relative, "Created");
-        m_logDialog->addLog(QString("%1: New file created - %2")
+        logFileEvent(&m_eventLogSummary.created, QString("%1: New file created - %2")
             .arg(getSystemName(systemIndex)).arg(relative));
 
         // Automatic Telegram notification removed - only send via "Copy Send" button
         return;
     }
 
-    // CRITICAL: Compare old vs new content byte-by-byte
-    if (oldContent == newContent) {
+    // CRITICAL: Compare size first, then the content hash, and the bytes
+    // themselves only when the hashes match
+    const ChangeDetector::Result check = m_changeDetector.check(filePath, *baseline);
+    if (check.verdict == ChangeDetector::Verdict::Unreadable) {
+        logFileEvent(&m_eventLogSummary.failed, QString("%1: Failed to read file - %2")
+            .arg(getSystemName(systemIndex)).arg(filePath));
+        return;
+    }
+    if (check.verdict == ChangeDetector::Verdict::Identical) {
         // File content hasn't actually changed (maybe just timestamp/attributes)
         // This is a false alarm - log but don't show in table
-        m_logDialog->addLog(QString("%1: Ignored false change for %2 (content identical)")
-            .arg(getSystemName(systemIndex)).arg(relative));
+        logFileEvent(&m_eventLogSummary.unchanged, QString("%1: Ignored false change for %2 (content identical, %3 check)")
+            .arg(getSystemName(systemIndex)).arg(relative)
+            .arg(ChangeDetector::tierName(check.tier)));
         return;
     }
+    if (check.tier == ChangeDetector::Tier::FullCompare) {
+        m_logDialog->addLog(QString("%1: Hash collision on %2 - content differs despite equal hashes")
+            .arg(getSystemName(systemIndex)).arg(relative));
+    }
+
+    const qint64 oldSize = baseline->size;
+    const qint64 newSize = check.newSize;
+
+    // Hash-only and snapshot-restored baselines keep no content; recover the
+    // old version the first time the file changes so the diff viewer has
+    // something to compare. Reading copies and running git can take a while,
+    // so it happens on a worker and the entry is updated when it is done.
+    if (!baseline->hasContent() && !baseline->contentLost) {
+        if (maxContentBytes > 0 && oldSize > maxContentBytes) {
+            panel.table->baseline().markContentLost(relative);
+            m_logDialog->addLog(QString("%1: %2 exceeds the baseline size cap - tracked by hash only")
+                .arg(getSystemName(systemIndex)).arg(relative));
+        } else {
+            queueBaselineRecovery(systemIndex, relative, *baseline);
+        }
+    }
 
     // Content has REALLY changed - calculate change size for logging
-    qint64 oldSize = oldContent.toUtf8().size();
-    qint64 newSize = newContent.toUtf8().size();
     qint64 sizeDiff = newSize - oldSize;
     QString sizeInfo = QString("(%1 bytes → %2 bytes, %3%4)")
         .arg(oldSize)
@@ -671,11 +832,10 @@ void FileWatcherApp::handleFileChanged(int systemIndex, const QString& filePath)
 
     // Update table
     panel.table->updateFileEntry(relative, "Modified");
-    m_logDialog->addLog(QString("%1: File modified - %2 %3")
+    logFileEvent(&m_eventLogSummary.modified, QString("%1: File modified - %2 %3")
         .arg(getSystemName(systemIndex)).arg(relative).arg(sizeInfo));
 
     // DO NOT update baseline - keep original content for comparison
-    // panel.table->setFileContent(relative, newContent);
 
     // Automatic Telegram notification removed - only send via "Copy Send" button
 }
@@ -687,19 +847,29 @@ void FileWatcherApp::handleFileCreated(int systemIndex, const QString& filePath)
     }
 
     auto& panel = m_systemPanels[systemIndex];
+    if (panel.capturingBaseline) {
+        panel.deferredChanges << filePath;
+        return;
+    }
     const QString sourceRoot = m_systemConfigs.value(systemIndex).source;
+    const QString relative = QDir(sourceRoot).relativeFilePath(filePath);
     if (panel.table) {
-        const QString relative = QDir(sourceRoot).relativeFilePath(filePath);
         panel.table->addFileEntry(relative, "Created");
     }
 
-    QString content = readFileContent(filePath);
-    if (!content.isNull() && panel.table) {
-        const QString relative = QDir(sourceRoot).relativeFilePath(filePath);
-        panel.table->setFileContent(relative, content);
+    // Fingerprint the raw bytes, as the change check will compare them
+    BaselineEntry entry;
+    if (!readBaselineEntry(filePath, &entry)) {
+        logFileEvent(&m_eventLogSummary.created, QString("%1: File created - %2 (not readable yet)").arg(getSystemName(systemIndex)).arg(filePath));
+        return;
+    }
+    if (panel.table) {
+        panel.table->baseline().insert(relative, entry);
     }
 
-    m_logDialog->addLog(QString("%1: File created - %2").arg(getSystemName(systemIndex)).arg(filePath));
+    logFileEvent(&m_eventLogSummary.created, entry.hasContent()
+        ? QString("%1: File created - %2").arg(getSystemName(systemIndex)).arg(filePath)
+        : QString("%1: File created - %2 (above size cap, not kept in baseline)").arg(getSystemName(systemIndex)).arg(filePath));
 }
 
 void FileWatcherApp::handleFileDeleted(int systemIndex, const QString& filePath)
@@ -709,13 +879,93 @@ void FileWatcherApp::handleFileDeleted(int systemIndex, const QString& filePath)
     }
 
     auto& panel = m_systemPanels[systemIndex];
+    if (panel.capturingBaseline) {
+        panel.deferredDeletions << filePath;
+        return;
+    }
     const QString sourceRoot = m_systemConfigs.value(systemIndex).source;
     if (panel.table) {
         const QString relative = QDir(sourceRoot).relativeFilePath(filePath);
         panel.table->removeFileEntry(relative);
     }
 
-    m_logDialog->addLog(QString("%1: File deleted - %2").arg(getSystemName(systemIndex)).arg(filePath));
+    logFileEvent(&m_eventLogSummary.deleted, QString("%1: File deleted - %2").arg(getSystemName(systemIndex)).arg(filePath));
+}
+
+void FileWatcherApp::handleDirectoryRemoved(int systemIndex, const QString& dirPath)
+{
+    if (systemIndex < 0 || systemIndex >= m_systemPanels.size()) {
+        return;
+    }
+
+    auto& panel = m_systemPanels[systemIndex];
+    if (panel.capturingBaseline) {
+        panel.deferredDirectoryRemovals << dirPath;
+        return;
+    }
+    if (!panel.table) {
+        return;
+    }
+
+    // Moved out of the tree or excluded: its files got no events of their own
+    const QString relative = QDir(m_systemConfigs.value(systemIndex).source).relativeFilePath(dirPath);
+    const int removed = panel.table->removeEntriesBelow(relative);
+    if (m_eventLogSummary.active) {
+        m_eventLogSummary.deleted += removed;
+    } else if (removed > 0) {
+        m_logDialog->addLog(QString("%1: Directory removed - %2 (%3 file(s) dropped)")
+            .arg(getSystemName(systemIndex)).arg(relative).arg(removed));
+    }
+}
+
+void FileWatcherApp::handleFileRenamed(int systemIndex, const QString& oldPath,
+                                       const QString& newPath, bool isDirectory)
+{
+    if (systemIndex < 0 || systemIndex >= m_systemPanels.size()) {
+        return;
+    }
+
+    auto& panel = m_systemPanels[systemIndex];
+    if (panel.capturingBaseline) {
+        // Replayed once the baseline exists under the old paths
+        FileEvent rename;
+        rename.path = newPath;
+        rename.kind = FileEvent::Kind::Renamed;
+        rename.oldPath = oldPath;
+        rename.isDirectory = isDirectory;
+        panel.deferredRenames.append(rename);
+        return;
+    }
+    if (!panel.table) {
+        return;
+    }
+
+    const QDir root(m_systemConfigs.value(systemIndex).source);
+    const QString oldRelative = root.relativeFilePath(oldPath);
+    const QString newRelative = root.relativeFilePath(newPath);
+
+    if (!isDirectory && panel.table->baseline().contains(newRelative)) {
+        // Moved over an existing file, whose own baseline stays the reference
+        logFileEvent(nullptr, QString("%1: %2 replaced %3")
+            .arg(getSystemName(systemIndex)).arg(oldRelative).arg(newRelative));
+        handleFileDeleted(systemIndex, oldPath);
+        handleFileChanged(systemIndex, newPath);
+        return;
+    }
+
+    // The baseline moves with the file; its content is not read again
+    const int moved = panel.table->renameEntries(oldRelative, newRelative, isDirectory);
+    if (!isDirectory && moved == 0) {
+        // Nothing was known about it (e.g. over the size cap), so list it as new
+        handleFileCreated(systemIndex, newPath);
+        return;
+    }
+
+    logFileEvent(&m_eventLogSummary.renamed, isDirectory
+        ? QString("%1: Directory renamed - %2 -> %3 (%4 file(s) moved)")
+            .arg(getSystemName(systemIndex)).arg(oldRelative).arg(newRelative).arg(moved)
+        : QString("%1: File renamed - %2 -> %3")
+            .arg(getSystemName(systemIndex)).arg(oldRelative).arg(newRelative));
 }
 
 void FileWatcherApp::handleCopyRequested(int systemIndex)
@@ -1089,9 +1339,7 @@ void FileWatcherApp::handleAssignToRequested(int systemIndex)
         m_logDialog->addLog(QString("%1: Watcher list cleared").arg(getSystemName(systemIndex)));
         
         // Re-capture baseline from current file state so future changes are compared correctly
-        QStringList excludedFolders = ruleListForSystem(m_withoutRules, systemIndex);
-        QStringList excludedFiles = ruleListForSystem(m_exceptRules, systemIndex);
-        captureBaselineForSystem(systemIndex, config, excludedFolders, excludedFiles);
+        captureBaselineForSystem(systemIndex, config, exclusionMatcherForSystem(systemIndex));
         m_logDialog->addLog(QString("%1: Baseline updated to current state").arg(getSystemName(systemIndex)));
     }
     
@@ -1138,9 +1386,9 @@ void FileWatcherApp::handleViewDiffRequested(int systemIndex, const QString& fil
     // Get the baseline (old) content
     QString oldContent = panel.table->getFileContent(filePath);
     
-    // Get the absolute file path
+    // Get the absolute file path, spelled as the watcher reports it
     const QString sourceRoot = m_systemConfigs.value(systemIndex).source;
-    QString absolutePath = QDir(sourceRoot).absoluteFilePath(filePath);
+    QString absolutePath = QDir::cleanPath(QDir(sourceRoot).absoluteFilePath(filePath));
     
     // Check if file exists
     if (!QFile::exists(absolutePath)) {
@@ -1152,13 +1400,15 @@ void FileWatcherApp::handleViewDiffRequested(int systemIndex, const QString& fil
     // If no baseline, use empty string
     if (oldContent.isNull()) {
         oldContent = "";
-        m_diffDialog->setWindowTitle(QString("%1: %2 (New File) - Live View").arg(getSystemName(systemIndex)).arg(filePath));
+        const QString label = panel.table->baseline().contains(filePath) ? "Baseline Unavailable" : "New File";
+        m_diffDialog->setWindowTitle(QString("%1: %2 (%3) - Live View").arg(getSystemName(systemIndex)).arg(filePath).arg(label));
     } else {
         m_diffDialog->setWindowTitle(QString("%1: %2 - Live View").arg(getSystemName(systemIndex)).arg(filePath));
     }
     
-    // Use live file monitoring
-    m_diffDialog->setLiveFile(absolutePath, oldContent);
+    // Use live file monitoring, driven by watcher events where there are any
+    m_diffSystemIndex = systemIndex;
+    m_diffDialog->setLiveFile(absolutePath, oldContent, isWatchedFile(systemIndex, absolutePath));
     m_diffDialog->show();
     m_diffDialog->raise();
     m_diffDialog->activateWindow();
@@ -1168,168 +1418,258 @@ void FileWatcherApp::handleViewDiffRequested(int systemIndex, const QString& fil
 
 void FileWatcherApp::captureBaselineForSystem(int systemIndex,
                                               const SettingsDialog::SystemConfigData& config,
-                                              const QStringList& excludedFolders,
-                                              const QStringList& excludedFiles)
-{
-    // This is a wrapper for backward compatibility
-    captureBaselineForSystemWithProgress(systemIndex, config, excludedFolders, excludedFiles, 0, 0);
-}
-
-void FileWatcherApp::captureBaselineForSystemWithProgress(int systemIndex,
-                                                          const SettingsDialog::SystemConfigData& config,
-                                                          const QStringList& excludedFolders,
-                                                          const QStringList& excludedFiles,
-                                                          int cumulativeProcessed,
-                                                          int totalFilesAllSystems)
+                                              const ExclusionMatcher& exclusions)
 {
     if (systemIndex < 0 || systemIndex >= m_systemPanels.size()) {
         return;
     }
-    if (config.source.isEmpty()) {
+    if (config.source.isEmpty() || !m_systemPanels[systemIndex].table) {
         return;
     }
 
-    auto& panel = m_systemPanels[systemIndex];
-    if (!panel.table) {
-        return;
-    }
+    // Hold back watcher events until the new baseline is complete, otherwise
+    // files not loaded yet would be reported as newly created
+    m_systemPanels[systemIndex].capturingBaseline = true;
 
-    // Capture baseline with cumulative progress tracking
-    QDirIterator it(config.source, QDir::Files | QDir::NoSymLinks | QDir::NoDotAndDotDot, QDirIterator::Subdirectories);
-    int fileCount = 0;
-    int processedFiles = 0;
+    BaselineLoader::Job job;
+    job.systemIndex = systemIndex;
+    job.systemName = getSystemName(systemIndex);
+    job.sourceRoot = config.source;
+    job.exclusions = exclusions;
+    job.hashOnly = AppConfig::instance().hashOnlyBaseline();
+    job.maxContentBytes = maxBaselineContentBytes();
 
-    while (it.hasNext()) {
-        QString path = it.next();
-        if (isPathExcluded(path, excludedFolders, excludedFiles)) {
-            continue;
+    BaselineLoader* loader = createBaselineLoader();
+    connect(loader, &BaselineLoader::finished, this, [this, loader, systemIndex](bool) {
+        loader->deleteLater();
+        if (systemIndex >= m_systemPanels.size()) {
+            return;
         }
 
-        processedFiles++;
-        int totalProcessed = cumulativeProcessed + processedFiles;
-        
-        // Update progress every 10 files or on last file
-        if (processedFiles % 10 == 0) {
-            updateProgress(totalProcessed);
-            
-            // Process events to keep UI responsive
-            QCoreApplication::processEvents();
-            
-            // Log progress every 100 files
-            if (totalProcessed % 100 == 0) {
-                int percentage = totalFilesAllSystems > 0 ? (totalProcessed * 100) / totalFilesAllSystems : 0;
-                m_logDialog->addLog(QString("Overall progress: %1% (%2/%3) - Processing %4...")
-                    .arg(percentage)
-                    .arg(totalProcessed)
-                    .arg(totalFilesAllSystems)
-                    .arg(getSystemName(systemIndex)));
-            }
+        auto& panel = m_systemPanels[systemIndex];
+        panel.capturingBaseline = false;
+
+        FileEventBatch deferred;
+        for (const QString& path : panel.deferredDirectoryRemovals) {
+            FileEvent removal{path, FileEvent::Kind::Deleted};
+            removal.isDirectory = true;
+            deferred.append(removal);
+        }
+        for (const QString& path : panel.deferredDeletions) {
+            deferred.append(FileEvent{path, FileEvent::Kind::Deleted});
+        }
+        deferred += panel.deferredRenames;
+        for (const QString& path : panel.deferredChanges) {
+            deferred.append(FileEvent{path, FileEvent::Kind::Changed});
         }
+        panel.deferredDeletions.clear();
+        panel.deferredDirectoryRemovals.clear();
+        panel.deferredRenames.clear();
+        panel.deferredChanges.clear();
+        handleFileEvents(systemIndex, deferred);
+    });
+
+    loader->start({job});
+}
 
-        QString content = readFileContent(path);
-        if (!content.isNull()) {
-            const QString relative = QDir(config.source).relativeFilePath(path);
-            panel.table->setFileContent(relative, content);
-            ++fileCount;
+BaselineLoader* FileWatcherApp::createBaselineLoader()
+{
+    BaselineLoader* loader = new BaselineLoader(this);
+    BlobStore::instance().setMemoryBudget(qint64(AppConfig::instance().baselineMemoryBudgetMb()) * 1024 * 1024);
+
+    // Merge each batch into the per-system store as it arrives
+    connect(loader, &BaselineLoader::batchLoaded, this,
+            [this](int systemIndex, const BaselineBatch& files) {
+        if (systemIndex < 0 || systemIndex >= m_systemPanels.size()) {
+            return;
         }
-    }
-    
-    // Final progress update for this system
-    updateProgress(cumulativeProcessed + processedFiles);
-    QCoreApplication::processEvents();
+        FileWatcherTable* table = m_systemPanels[systemIndex].table;
+        if (!table) {
+            return;
+        }
+        BaselineStore& store = table->baseline();
+        for (const BaselineFile& file : files) {
+            BaselineEntry entry;
+            entry.size = file.size;
+            entry.hash = file.hash;
+            entry.content = file.content;
+            store.insert(file.relativePath, entry);
+        }
+    });
+    connect(loader, &BaselineLoader::snapshotReused, this, [this](int systemIndex, int reusedFiles) {
+        m_logDialog->addLog(QString("%1: Reused %2 unchanged files from the saved baseline").arg(getSystemName(systemIndex)).arg(reusedFiles));
+    });
+    connect(loader, &BaselineLoader::systemFinished, this, [this](int systemIndex, int fileCount) {
+        if (fileCount > 0) {
+            m_logDialog->addLog(QString("%1: ✓ Captured baseline for %2 files").arg(getSystemName(systemIndex)).arg(fileCount));
+        }
+        const BlobStore& blobs = BlobStore::instance();
+        m_logDialog->addLog(QString("Baseline content: %1 unique files, %2 KB in memory + %3 KB spilled, compressed from %4 KB (%5 KB before sharing)")
+            .arg(blobs.blobCount())
+            .arg(blobs.storedBytes() / 1024)
+            .arg(blobs.spilledBytes() / 1024)
+            .arg(blobs.rawBytes() / 1024)
+            .arg(blobs.referencedBytes() / 1024));
+        if (blobs.rejectedBytes() > 0) {
+            m_logDialog->addLog(QString("Baseline spill file unavailable - %1 KB kept as hash only")
+                .arg(blobs.rejectedBytes() / 1024));
+        }
+    });
 
-    if (fileCount > 0) {
-        m_logDialog->addLog(QString("%1: ✓ Captured baseline for %2 files").arg(getSystemName(systemIndex)).arg(fileCount));
-    }
+    return loader;
 }
 
-bool FileWatcherApp::isPathExcluded(const QString& absolutePath,
-                                    const QStringList& excludedFolders,
-                                    const QStringList& excludedFiles) const
+ExclusionMatcher FileWatcherApp::exclusionMatcherForSystem(int systemIndex) const
 {
-    const QString normalized = QDir::toNativeSeparators(absolutePath);
+    // Only the Except table excludes files from watching; the Without table
+    // is only used for folder path removal when copying
+    return ExclusionMatcher(QStringList(), ruleListForSystem(m_exceptRules, systemIndex));
+}
 
-    // Auto-exclude common temporary/backup file patterns
-    QFileInfo fileInfo(normalized);
-    QString fileName = fileInfo.fileName();
-    
-    // Exclude editor backup files (ending with ~)
-    if (fileName.endsWith('~')) {
-        return true;
+bool FileWatcherApp::isWatchedFile(int systemIndex, const QString& absolutePath) const
+{
+    if (systemIndex < 0 || systemIndex >= m_systemPanels.size() || !m_systemPanels[systemIndex].watching) {
+        return false;
     }
-    
-    // Exclude vim swap files
-    if (fileName.endsWith(".swp") || fileName.endsWith(".swo") || 
-        (fileName.startsWith(".") && fileName.contains(".sw"))) {
-        return true;
+    return !exclusionMatcherForSystem(systemIndex).isExcluded(absolutePath);
+}
+
+void FileWatcherApp::queueBaselineRecovery(int systemIndex, const QString& relativePath,
+                                           const BaselineEntry& expected)
+{
+    if (systemIndex < 0 || systemIndex >= m_systemConfigs.size()) {
+        return;
     }
-    
-    // Exclude common temp files
-    if (fileName.endsWith(".tmp") || fileName.endsWith(".temp") || 
-        fileName.endsWith(".bak") || fileName.endsWith(".old")) {
-        return true;
+    const auto key = qMakePair(systemIndex, relativePath);
+    if (m_recoveringPaths.contains(key)) {
+        return;
     }
+    m_recoveringPaths.insert(key);
+
+    // Everything the worker needs is taken from the settings here
+    const auto& config = m_systemConfigs[systemIndex];
+    BaselineRecovery recovery;
+    recovery.systemIndex = systemIndex;
+    recovery.relativePath = relativePath;
+    recovery.size = expected.size;
+    recovery.hash = expected.hash;
+    recovery.snapshotLocation = BaselineSnapshot::locationFor(getSystemName(systemIndex), config.source);
+
+    // Copies left by the last Copy: git keeps the full relative path, the
+    // destination is flattened for files in the Without list
+    if (!config.git.isEmpty()) {
+        recovery.gitRoot = config.git;
+        recovery.candidates << QDir(config.git).filePath(relativePath);
+    }
+    if (!config.destination.isEmpty()) {
+        recovery.candidates << (isFileInWithoutList(systemIndex, relativePath)
+            ? QDir(config.destination).filePath(QFileInfo(relativePath).fileName())
+            : QDir(config.destination).filePath(relativePath));
+    }
+
+    m_pendingRecoveries.append(recovery);
+    startBaselineRecovery();
+}
+
+void FileWatcherApp::startBaselineRecovery()
+{
+    if (m_recoveryWatcher->isRunning() || m_pendingRecoveries.isEmpty()) {
+        return;
+    }
+    QVector<BaselineRecovery> batch;
+    batch.swap(m_pendingRecoveries);
+    m_recoveryWatcher->setFuture(QtConcurrent::mapped(std::move(batch), &FileWatcherApp::recoverBaselineContent));
+}
 
-    // Check excluded folders (from "Without" list)
-    for (const QString& folder : excludedFolders) {
-        const QString trimmed = folder.trimmed();
-        if (trimmed.isEmpty()) {
+void FileWatcherApp::applyBaselineRecoveries(int begin, int end)
+{
+    for (int i = begin; i < end; ++i) {
+        const BaselineRecovery recovery = m_recoveryWatcher->resultAt(i);
+        m_recoveringPaths.remove(qMakePair(recovery.systemIndex, recovery.relativePath));
+        if (recovery.systemIndex >= m_systemPanels.size() || !m_systemPanels[recovery.systemIndex].table) {
             continue;
         }
-        
-        // Check if folder appears as a path component (exact name match)
-        // Match "\foldername\" anywhere in path OR "\foldername" at end
-        QString sep = QDir::separator();
-        QString folderInPath = sep + trimmed + sep;
-        QString folderAtEnd = sep + trimmed;
-        
-        if (normalized.contains(folderInPath, Qt::CaseInsensitive) ||
-            normalized.endsWith(folderAtEnd, Qt::CaseInsensitive)) {
-            return true;
+
+        // The entry may have been re-captured, renamed or removed meanwhile
+        BaselineStore& baseline = m_systemPanels[recovery.systemIndex].table->baseline();
+        const BaselineEntry* entry = baseline.find(recovery.relativePath);
+        if (!entry || entry->hasContent() || entry->contentLost ||
+            entry->size != recovery.size || entry->hash != recovery.hash) {
+            continue;
         }
-    }
 
-    // Check excluded files (from "Except" list)
-    for (const QString& filePattern : excludedFiles) {
-        const QString trimmed = filePattern.trimmed();
-        if (trimmed.isEmpty()) {
+        const QString systemName = getSystemName(recovery.systemIndex);
+        if (recovery.content.isNull()) {
+            baseline.markContentLost(recovery.relativePath);
+            m_logDialog->addLog(QString("%1: No copy matches the baseline of %2 - diff will show the file as new")
+                .arg(systemName).arg(recovery.relativePath));
             continue;
         }
-        
-        // Check if it's a folder pattern (doesn't have file extension)
-        bool isFolder = !trimmed.contains('.') || trimmed.startsWith(".");
-        
-        if (isFolder) {
-            // Treat as folder - check as path component
-            // Match "\foldername\" anywhere in path OR "\foldername" at end
-            QString sep = QDir::separator();
-            QString folderInPath = sep + trimmed + sep;
-            QString folderAtEnd = sep + trimmed;
-            
-            if (normalized.contains(folderInPath, Qt::CaseInsensitive) ||
-                normalized.endsWith(folderAtEnd, Qt::CaseInsensitive)) {
-                return true;
-            }
-        } else {
-            // Treat as file pattern - check for exact filename match
-            if (fileName.compare(trimmed, Qt::CaseInsensitive) == 0) {
-                return true;
-            }
+
+        baseline.retainContent(recovery.relativePath, recovery.content);
+        m_logDialog->addLog(QString("%1: Recovered baseline content for %2 from %3")
+            .arg(systemName).arg(recovery.relativePath).arg(recovery.origin));
+
+        // A diff already open on the file was showing it as new
+        const QString absolutePath = QDir::cleanPath(
+            QDir(m_systemConfigs.value(recovery.systemIndex).source).absoluteFilePath(recovery.relativePath));
+        if (recovery.systemIndex == m_diffSystemIndex && m_diffDialog->isVisible()
+            && m_diffDialog->liveFilePath() == absolutePath) {
+            handleViewDiffRequested(recovery.systemIndex, recovery.relativePath);
         }
     }
-
-    return false;
 }
 
-QString FileWatcherApp::readFileContent(const QString& filePath) const
+FileWatcherApp::BaselineRecovery FileWatcherApp::recoverBaselineContent(const BaselineRecovery& request)
 {
-    QFile file(filePath);
-    if (!file.open(QIODevice::ReadOnly)) {
-        return QString();
+    BaselineRecovery recovery = request;
+
+    // Only accept a copy whose fingerprint matches what was captured
+    auto matchesBaseline = [&request](const QByteArray& data) {
+        return data.size() == request.size && ContentHasher::hash(data) == request.hash;
+    };
+
+    // The persisted snapshot holds the captured content under its hash
+    bool fromSnapshot = false;
+    const QByteArray snapshotData = BaselineSnapshot::readBlob(request.snapshotLocation, request.hash, &fromSnapshot);
+    if (fromSnapshot && matchesBaseline(snapshotData)) {
+        recovery.origin = "baseline snapshot";
+        recovery.content = BlobStore::instance().intern(snapshotData, request.hash);
+        return recovery;
+    }
+
+    for (const QString& candidate : request.candidates) {
+        if (QFileInfo(candidate).size() != request.size) {
+            continue;
+        }
+        MappedFile file(candidate);
+        QByteArray data;
+        bool ok = false;
+        const quint64 hash = file.fingerprint(0, &data, &ok);
+        if (ok && !data.isNull() && data.size() == request.size && hash == request.hash) {
+            recovery.origin = candidate;
+            recovery.content = BlobStore::instance().intern(data, request.hash);
+            return recovery;
+        }
     }
-    QByteArray data = file.readAll();
-    file.close();
-    return QString::fromUtf8(data);
+
+    // Fall back to the committed version when the git path is a work tree
+    if (!request.gitRoot.isEmpty() && QDir(request.gitRoot).exists()) {
+        QProcess git;
+        git.setWorkingDirectory(request.gitRoot);
+        git.start("git", {"show", QString("HEAD:./%1").arg(QDir::fromNativeSeparators(request.relativePath))});
+        if (!git.waitForFinished(GIT_SHOW_TIMEOUT_MS)) {
+            git.kill();
+            git.waitForFinished();
+        } else if (git.exitStatus() == QProcess::NormalExit && git.exitCode() == 0) {
+            const QByteArray data = git.readAllStandardOutput();
+            if (matchesBaseline(data)) {
+                recovery.origin = "git HEAD";
+                recovery.content = BlobStore::instance().intern(data, request.hash);
+            }
+        }
+    }
+    return recovery;
 }
 
 QString FileWatcherApp::getSystemName(int systemIndex) const
@@ -1340,7 +1680,7 @@ QString FileWatcherApp::getSystemName(int systemIndex) const
             return name;
         }
     }
-    return getSystemName(systemIndex);
+    return QString("System %1").arg(systemIndex + 1);
 }
 
 void FileWatcherApp::onStartWatching()
@@ -1384,6 +1724,7 @@ void FileWatcherApp::onSettingsClicked()
         m_telegramToken = m_settingsDialog->getTelegramToken();
         m_telegramChatId = m_settingsDialog->getTelegramChatId();
         m_notificationsEnabled = m_settingsDialog->isNotificationsEnabled();
+        AppConfig::instance().setHashOnlyBaseline(m_settingsDialog->isHashOnlyBaseline());
         m_systemConfigs = m_settingsDialog->systemConfigs();
         m_withoutRules = m_settingsDialog->withoutData();
         m_exceptRules = m_settingsDialog->exceptData();
@@ -1481,120 +1822,147 @@ void FileWatcherApp::startWatching()
         return;
     }
 
-    bool startedAny = false;
-    
-    // First pass: Count total files across all selected systems
-    m_logDialog->addLog("=== Counting files for all systems ===");
-    int totalFilesAllSystems = 0;
-    QVector<int> systemFileCounts;
-    
+    // A single scan per system feeds the progress total, the baseline readers
+    // and watch registration
+    m_changeDetector.resetStats();
+    m_logDialog->addLog("=== Scanning source trees for all systems ===");
+    m_logDialog->addLog(QString("Content hashing uses the %1 kernel").arg(ContentHasher::kernelName()));
+    showProgressDialog("Scanning source trees - Please Wait...", 0);
+
+    QVector<BaselineLoader::Job> jobs;
     for (int i : selectedIndices) {
         if (i >= m_systemConfigs.size() || i >= m_systemPanels.size()) {
-            systemFileCounts.append(0);
             continue;
         }
 
         const auto& config = m_systemConfigs.at(i);
         if (config.source.isEmpty()) {
-            systemFileCounts.append(0);
             continue;
         }
-        
-        QStringList excludedFolders;
-        QStringList excludedFiles = ruleListForSystem(m_exceptRules, i);
-        
-        // Count files for this system
-        QDirIterator countIt(config.source, QDir::Files | QDir::NoSymLinks | QDir::NoDotAndDotDot, QDirIterator::Subdirectories);
-        int systemFileCount = 0;
-        
-        while (countIt.hasNext()) {
-            QString path = countIt.next();
-            if (!isPathExcluded(path, excludedFolders, excludedFiles)) {
-                systemFileCount++;
+
+        auto& panel = m_systemPanels[i];
+        if (!panel.table) {
+            continue;
+        }
+        panel.table->clearTable();
+
+        // Compiled once and shared by the scan, baseline capture and the watcher thread
+        BaselineLoader::Job job;
+        job.systemIndex = i;
+        job.systemName = getSystemName(i);
+        job.sourceRoot = config.source;
+        job.exclusions = exclusionMatcherForSystem(i);
+        job.hashOnly = AppConfig::instance().hashOnlyBaseline();
+        job.maxContentBytes = maxBaselineContentBytes();
+        jobs.append(job);
+    }
+
+    BaselineLoader* loader = createBaselineLoader();
+    auto totalFilesAllSystems = std::make_shared<int>(0);
+    connect(loader, &BaselineLoader::systemScanned, this, [this](int systemIndex, int fileCount) {
+        m_logDialog->addLog(QString("%1: %2 files found").arg(getSystemName(systemIndex)).arg(fileCount));
+    });
+    connect(loader, &BaselineLoader::scanFinished, this, [this, totalFilesAllSystems](int totalFiles) {
+        *totalFilesAllSystems = totalFiles;
+        m_logDialog->addLog(QString("=== Capturing baseline for %1 total files ===").arg(totalFiles));
+        if (m_progressDialog) {
+            m_progressDialog->setLabelText(QString("Capturing Baseline (%1 files) - Please Wait...").arg(totalFiles));
+            m_progressDialog->setMaximum(totalFiles);
+        }
+    });
+    connect(loader, &BaselineLoader::progress, this, [this, totalFilesAllSystems](int processed) {
+        updateProgress(processed);
+        const int total = *totalFilesAllSystems;
+        int percentage = total > 0 ? (processed * 100) / total : 0;
+        m_logDialog->addLog(QString("Overall progress: %1% (%2/%3)")
+            .arg(percentage)
+            .arg(processed)
+            .arg(total));
+    });
+    connect(loader, &BaselineLoader::finished, this, [this, loader](bool cancelled) {
+        const QVector<BaselineLoader::Job> completedJobs = loader->jobs();
+        loader->deleteLater();
+        finishStartWatching(completedJobs, cancelled);
+    });
+    if (m_progressDialog) {
+        connect(m_progressDialog, &QProgressDialog::canceled, loader, &BaselineLoader::cancel);
+    }
+
+    loader->start(jobs);
+    // Watchers are started in finishStartWatching once the baseline is complete
+}
+
+void FileWatcherApp::finishStartWatching(const QVector<BaselineLoader::Job>& jobs, bool cancelled)
+{
+    // Close progress dialog after all systems are processed
+    closeProgressDialog();
+
+    if (cancelled) {
+        for (const BaselineLoader::Job& job : jobs) {
+            if (job.systemIndex < m_systemPanels.size() && m_systemPanels[job.systemIndex].table) {
+                m_systemPanels[job.systemIndex].table->clearTable();
             }
         }
-        
-        systemFileCounts.append(systemFileCount);
-        totalFilesAllSystems += systemFileCount;
-        m_logDialog->addLog(QString("%1: %2 files found").arg(getSystemName(i)).arg(systemFileCount));
+        m_logDialog->addLog("Baseline capture cancelled - watching not started");
+        m_watchToggleButton->setText("Start Watching");
+        m_watchToggleButton->setEnabled(true);
+        updateStatusLabel();
+        return;
     }
-    
+
+    int totalFilesAllSystems = 0;
+    for (const BaselineLoader::Job& job : jobs) {
+        totalFilesAllSystems += job.manifest ? job.manifest->fileCount() : 0;
+    }
+
     if (totalFilesAllSystems == 0) {
         m_logDialog->addLog("No files found in any system");
         m_watchToggleButton->setText("Start Watching");
         m_watchToggleButton->setEnabled(true);
+        updateStatusLabel();
         QMessageBox::warning(this, "No Files", "No files found in any selected system source directories.");
         return;
     }
-    
-    // Show single progress dialog for all systems combined
-    m_logDialog->addLog(QString("=== Capturing baseline for %1 total files ===").arg(totalFilesAllSystems));
-    showProgressDialog(QString("Capturing Baseline (%1 files) - Please Wait...").arg(totalFilesAllSystems), totalFilesAllSystems);
-    
-    int processedSoFar = 0;
-
-    // Second pass: Capture baseline for each system
-    for (int idx = 0; idx < selectedIndices.size(); ++idx) {
-        int i = selectedIndices[idx];
-        
-        if (i >= m_systemConfigs.size() || i >= m_systemPanels.size()) {
-            continue;
-        }
 
-        const auto& config = m_systemConfigs.at(i);
-        if (config.source.isEmpty()) {
-            continue;
-        }
-
-        auto& panel = m_systemPanels[i];
-        if (!panel.table) {
-            continue;
-        }
-        panel.table->clearTable();
-
-        // Only use Except table for file exclusion (Without table is only for folder path removal when copying)
-        QStringList excludedFolders;  // Empty - not used for exclusion
-        QStringList excludedFiles = ruleListForSystem(m_exceptRules, i);
-
-        m_logDialog->addLog(QString("=== %1: Processing %2 files ===").arg(getSystemName(i)).arg(systemFileCounts[idx]));
-        
-        // Capture baseline with cumulative progress
-        captureBaselineForSystemWithProgress(i, config, excludedFolders, excludedFiles, processedSoFar, totalFilesAllSystems);
-        
-        processedSoFar += systemFileCounts[idx];
-
-        WatcherThread* watcher = new WatcherThread(i, getSystemName(i), config.source, excludedFolders, excludedFiles);
-        panel.watcher = watcher;
+    // Every system is served by one watcher thread; overlapping roots share
+    // their watches
+    WatcherService* service = new WatcherService();
+    service->setDebounceInterval(AppConfig::instance().duplicateEventThreshold());
+    service->setCoalesceWindow(AppConfig::instance().eventCoalesceWindowMs());
+    service->setPollInterval(AppConfig::instance().pollIntervalMs());
+    for (const BaselineLoader::Job& job : jobs) {
+        addWatchRootForSystem(service, job.systemIndex, job.exclusions, job.manifest);
+    }
 
+    const bool startedAny = service->rootCount() > 0;
+    if (startedAny) {
         // Use Qt::QueuedConnection for all cross-thread signals
-        connect(watcher, &WatcherThread::startedWatching, this, [this, i]() {
-            m_logDialog->addLog(QString("%1 watcher started").arg(getSystemName(i)));
+        connect(service, &WatcherService::startedWatching, this, [this, service]() {
+            m_logDialog->addLog(QString("Watcher service started for %1 system(s)").arg(service->rootCount()));
         }, Qt::QueuedConnection);
-        connect(watcher, &WatcherThread::stoppedWatching, this, [this, i]() {
-            m_logDialog->addLog(QString("%1 watcher stopped").arg(getSystemName(i)));
+        connect(service, &WatcherService::stoppedWatching, this, [this]() {
+            m_logDialog->addLog("Watcher service stopped");
         }, Qt::QueuedConnection);
-        connect(watcher, &WatcherThread::preloadComplete, this, [this, i]() {
-            m_logDialog->addLog(QString("%1 preload complete").arg(getSystemName(i)));
+        connect(service, &WatcherService::preloadComplete, this, [this]() {
+            m_logDialog->addLog("Watcher preload complete");
         }, Qt::QueuedConnection);
-        connect(watcher, &WatcherThread::fileChanged, this, [this, i](const QString& path) {
-            handleFileChanged(i, path);
+        connect(service, &WatcherService::fileEvents, this,
+                [this](int systemIndex, const FileEventBatch& events) {
+            handleFileEvents(systemIndex, events);
         }, Qt::QueuedConnection);
-        connect(watcher, &WatcherThread::fileCreated, this, [this, i](const QString& path) {
-            handleFileCreated(i, path);
-        }, Qt::QueuedConnection);
-        connect(watcher, &WatcherThread::fileDeleted, this, [this, i](const QString& path) {
-            handleFileDeleted(i, path);
-        }, Qt::QueuedConnection);
-        connect(watcher, &WatcherThread::logMessage, this, [this, i](const QString& msg) {
-            m_logDialog->addLog(QString("%1: %2").arg(getSystemName(i)).arg(msg));
+        connect(service, &WatcherService::logMessage, this, [this](int systemIndex, const QString& msg) {
+            if (systemIndex < 0) {
+                m_logDialog->addLog(msg);
+            } else {
+                m_logDialog->addLog(QString("%1: %2").arg(getSystemName(systemIndex)).arg(msg));
+            }
         }, Qt::QueuedConnection);
 
-        watcher->start();
-        startedAny = true;
+        m_watcherService = service;
+        service->start();
+    } else {
+        delete service;
     }
-    
-    // Close progress dialog after all systems are processed
-    closeProgressDialog();
 
     if (startedAny) {
         m_isWatching = true;
@@ -1607,6 +1975,9 @@ void FileWatcherApp::startWatching()
         }
         
         updateStatusLabel();
+        if (m_diffDialog->isVisible()) {
+            m_diffDialog->setWatched(isWatchedFile(m_diffSystemIndex, m_diffDialog->liveFilePath()));
+        }
         m_logDialog->addLog("✓ File watching started successfully - All systems ready");
     } else {
         m_watchToggleButton->setText("Start Watching");
@@ -1616,6 +1987,37 @@ void FileWatcherApp::startWatching()
     }
 }
 
+bool FileWatcherApp::addWatchRootForSystem(WatcherService* service, int systemIndex,
+                                           const ExclusionMatcher& exclusions,
+                                           const std::shared_ptr<const FileManifest>& manifest)
+{
+    if (systemIndex < 0 || systemIndex >= m_systemPanels.size() ||
+        systemIndex >= m_systemConfigs.size()) {
+        return false;
+    }
+
+    const auto& config = m_systemConfigs.at(systemIndex);
+    auto& panel = m_systemPanels[systemIndex];
+    if (config.source.isEmpty() || !panel.table) {
+        return false;
+    }
+
+    WatcherService::Root root;
+    root.systemIndex = systemIndex;
+    root.systemName = getSystemName(systemIndex);
+    root.path = config.source;
+    if (config.watchMode == QLatin1String("polling")) {
+        root.mode = WatcherService::WatchMode::Polling;
+    } else if (config.watchMode == QLatin1String("mount")) {
+        root.mode = WatcherService::WatchMode::Mount;
+    }
+    root.exclusions = exclusions;
+    root.manifest = manifest;
+    service->addRoot(root);
+    panel.watching = true;
+    return true;
+}
+
 void FileWatcherApp::stopWatching()
 {
     if (!m_isWatching) {
@@ -1627,6 +2029,18 @@ void FileWatcherApp::stopWatching()
     m_isWatching = false;
     m_watchToggleButton->setText("Start Watching");
     m_logDialog->addLog("File watching stopped");
+
+    const ChangeDetector::Stats& checks = m_changeDetector.stats();
+    if (checks.checks > 0) {
+        m_logDialog->addLog(QString("Change checks: %1 - %2 changed by size, %3 changed by hash, "
+                                    "%4 equal hashes, %5 of them byte-compared (%6 collisions)")
+            .arg(checks.checks)
+            .arg(checks.sizeMismatches)
+            .arg(checks.hashMismatches)
+            .arg(checks.hashMatches)
+            .arg(checks.fullCompares)
+            .arg(checks.collisions));
+    }
     
     // Re-enable checkboxes when stopped
     for (QCheckBox* checkbox : m_systemCheckboxes) {
@@ -1770,7 +2184,7 @@ void FileWatcherApp::updateStatusLabel()
             ? QString("Sys%1").arg(i + 1) 
             : m_systemConfigs[i].name;
         
-        bool isWatching = m_isWatching && m_systemPanels[i].watcher != nullptr;
+        bool isWatching = m_isWatching && m_systemPanels[i].watching;
         if (isWatching) {
             watchingCount++;
         }
@@ -3,6 +3,8 @@
 
 #include <QMainWindow>
 #include <QMap>
+#include <QPair>
+#include <QSet>
 #include <QString>
 #include <QStringList>
 #include <QVector>
@@ -10,8 +12,14 @@
 #include <QStackedWidget>
 #include <memory>
 
+#include "core/baseline_store.h"
+#include "core/change_detector.h"
+#include "core/exclusion_matcher.h"
+#include "core/file_event.h"
+#include "services/baseline_loader.h"
 #include "ui/dialogs/settings_dialog.h"
 
+template <typename T> class QFutureWatcher;
 class QTableWidget;
 class QPushButton;
 class QLineEdit;
@@ -19,13 +27,20 @@ class QWidget;
 class QVBoxLayout;
 class QCheckBox;
 class QProgressDialog;
-class WatcherThread;
+class WatcherService;
 class TelegramService;
 class FileWatcherTable;
 class LogDialog;
 class FileDiffDialog;
 class ChangeReviewDialog;
 
+// Configuration constants
+namespace EventLogConfig {
+    // Larger event batches are logged as one summary row instead of a
+    // row per file, so a checkout or build doesn't flood the log
+    constexpr int MAX_DETAILED_EVENTS = 32;
+}
+
 /**
  * @brief Main application window
  */
@@ -58,9 +73,15 @@ private:
     void clearSystemPanels();
     void buildSystemPanel(int index, const SettingsDialog::SystemConfigData& config);
     QStringList ruleListForSystem(const QVector<QStringList>& rows, int systemIndex) const;
+    void handleFileEvents(int systemIndex, const FileEventBatch& events);
+    // Logs a per-file row, or only bumps summaryCount (if any) while a
+    // large batch is being summarized
+    void logFileEvent(int* summaryCount, const QString& message);
     void handleFileChanged(int systemIndex, const QString& filePath);
     void handleFileCreated(int systemIndex, const QString& filePath);
     void handleFileDeleted(int systemIndex, const QString& filePath);
+    void handleDirectoryRemoved(int systemIndex, const QString& dirPath);
+    void handleFileRenamed(int systemIndex, const QString& oldPath, const QString& newPath, bool isDirectory);
     void handleCopyRequested(int systemIndex);
     void handleCopySendRequested(int systemIndex);
     void handleAssignToRequested(int systemIndex);
@@ -68,18 +89,34 @@ private:
     void stopAllWatchers();
     void captureBaselineForSystem(int systemIndex,
                                   const SettingsDialog::SystemConfigData& config,
-                                  const QStringList& excludedFolders,
-                                  const QStringList& excludedFiles);
-    void captureBaselineForSystemWithProgress(int systemIndex,
-                                              const SettingsDialog::SystemConfigData& config,
-                                              const QStringList& excludedFolders,
-                                              const QStringList& excludedFiles,
-                                              int cumulativeProcessed,
-                                              int totalFilesAllSystems);
-    bool isPathExcluded(const QString& absolutePath,
-                        const QStringList& excludedFolders,
-                        const QStringList& excludedFiles) const;
-    QString readFileContent(const QString& filePath) const;
+                                  const ExclusionMatcher& exclusions);
+    BaselineLoader* createBaselineLoader();
+    void finishStartWatching(const QVector<BaselineLoader::Job>& jobs, bool cancelled);
+    bool addWatchRootForSystem(WatcherService* service, int systemIndex,
+                               const ExclusionMatcher& exclusions,
+                               const std::shared_ptr<const FileManifest>& manifest);
+    ExclusionMatcher exclusionMatcherForSystem(int systemIndex) const;
+    // Whether the watcher reports changes to a file of the system
+    bool isWatchedFile(int systemIndex, const QString& absolutePath) const;
+
+    // Old content of a hash-only baseline entry, looked up off the GUI thread
+    struct BaselineRecovery {
+        int systemIndex = -1;
+        QString relativePath;
+        qint64 size = 0;
+        quint64 hash = 0;
+        QString snapshotLocation;
+        QString gitRoot;
+        // Copies left by the last Copy, in order of preference
+        QStringList candidates;
+        // Filled in by the worker; null if no copy matched
+        BlobRef content;
+        QString origin;
+    };
+    void queueBaselineRecovery(int systemIndex, const QString& relativePath, const BaselineEntry& expected);
+    void startBaselineRecovery();
+    void applyBaselineRecoveries(int begin, int end);
+    static BaselineRecovery recoverBaselineContent(const BaselineRecovery& request);
     QString getSystemName(int systemIndex) const;
     void updateSystemCheckboxes();
     void updateStatusLabel();
@@ -123,10 +160,14 @@ private:
     std::unique_ptr<LogDialog> m_logDialog;
     std::unique_ptr<SettingsDialog> m_settingsDialog;
     std::unique_ptr<FileDiffDialog> m_diffDialog;
+    // System whose file the diff dialog shows
+    int m_diffSystemIndex = -1;
     std::unique_ptr<ChangeReviewDialog> m_changeReviewDialog;
 
     // Services
     std::unique_ptr<TelegramService> m_telegramService;
+    // One watcher thread serves every watched system
+    WatcherService* m_watcherService = nullptr;
 
     // Settings
     struct SystemPanel {
@@ -136,7 +177,12 @@ private:
         QPushButton* copyButton = nullptr;
         QPushButton* copySendButton = nullptr;
         QPushButton* assignToButton = nullptr;
-        WatcherThread* watcher = nullptr;
+        bool watching = false;
+        bool capturingBaseline = false;
+        QStringList deferredChanges;
+        QStringList deferredDeletions;
+        QStringList deferredDirectoryRemovals;
+        FileEventBatch deferredRenames;
     };
 
     QVector<SystemPanel> m_systemPanels;
@@ -150,6 +196,26 @@ private:
     QVector<QStringList> m_withoutRules;
     QVector<QStringList> m_exceptRules;
     QVector<int> m_selectedSystemIndices;
+    ChangeDetector m_changeDetector;
+
+    // Outcomes of the event batch being handled, when it is large enough
+    // to be logged as a summary
+    struct EventLogSummary {
+        bool active = false;
+        int modified = 0;
+        int created = 0;
+        int deleted = 0;
+        int renamed = 0;
+        int unchanged = 0;
+        int failed = 0;
+    };
+    EventLogSummary m_eventLogSummary;
+
+    // Baseline content recovery: one batch runs at a time, later requests
+    // wait for the next one; a path is queued once until its result is in
+    QFutureWatcher<BaselineRecovery>* m_recoveryWatcher;
+    QVector<BaselineRecovery> m_pendingRecoveries;
+    QSet<QPair<int, QString>> m_recoveringPaths;
 };
 
 #endif // MAIN_WINDOW_H
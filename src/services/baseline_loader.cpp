@@ -0,0 +1,181 @@
+#include "baseline_loader.h"
+#include "../utils/content_hash.h"
+#include "../utils/mapped_file.h"
+#include <QtConcurrent/QtConcurrent>
+#include <QDateTime>
+#include <QDebug>
+#include <QThread>
+
+BaselineLoader::BaselineLoader(QObject* parent)
+    : QObject(parent),
+      m_cancelled(false),
+      m_processedFiles(0),
+      m_loadedFiles(0),
+      m_reusedFiles(0)
+{
+    qRegisterMetaType<BaselineFile>();
+    qRegisterMetaType<BaselineBatch>();
+
+    // Reading is mostly I/O bound; one reader per core keeps NVMe saturated
+    m_readerPool.setMaxThreadCount(QThread::idealThreadCount());
+}
+
+BaselineLoader::~BaselineLoader()
+{
+    cancel();
+    m_future.waitForFinished();
+    m_readerPool.waitForDone();
+}
+
+void BaselineLoader::start(const QVector<Job>& jobs)
+{
+    if (isRunning()) {
+        return;
+    }
+
+    m_jobs = jobs;
+    m_cancelled = false;
+    m_processedFiles = 0;
+    m_loadedFiles = 0;
+    m_reusedFiles = 0;
+
+    // The scan is the producer; it runs on the global pool and feeds
+    // batches of manifest entries to the private reader pool
+    m_future = QtConcurrent::run([this]() {
+        runJobs();
+    });
+}
+
+void BaselineLoader::cancel()
+{
+    m_cancelled = true;
+    m_readerPool.clear();
+}
+
+void BaselineLoader::runJobs()
+{
+    // Phase 1: one walk per tree gives the progress total and the file list
+    int totalFiles = 0;
+    for (Job& job : m_jobs) {
+        if (m_cancelled) {
+            break;
+        }
+        if (!job.manifest) {
+            job.manifest = std::make_shared<const FileManifest>(
+                FileManifest::scan(job.sourceRoot, job.exclusions, &m_cancelled));
+        }
+        totalFiles += job.manifest->fileCount();
+        emit systemScanned(job.systemIndex, job.manifest->fileCount());
+    }
+
+    if (!m_cancelled) {
+        emit scanFinished(totalFiles);
+    }
+
+    // Phase 2: read the manifests in parallel
+    for (const Job& job : m_jobs) {
+        if (m_cancelled) {
+            break;
+        }
+
+        const int fileCount = job.manifest->fileCount();
+        auto capture = std::make_shared<Capture>();
+        capture->manifest = job.manifest;
+        capture->snapshot = BaselineSnapshot::load(
+            BaselineSnapshot::locationFor(job.systemName, job.manifest->root()), job.manifest->root());
+        capture->captureTimeNs = QDateTime::currentMSecsSinceEpoch() * 1000000LL;
+        capture->hashes.assign(fileCount, 0);
+        capture->captured.assign(fileCount, 0);
+        capture->hashOnly = job.hashOnly;
+        capture->maxContentBytes = job.maxContentBytes;
+
+        for (int first = 0; first < fileCount && !m_cancelled; first += BaselineConfig::FILES_PER_BATCH) {
+            const int count = qMin(BaselineConfig::FILES_PER_BATCH, fileCount - first);
+            const int systemIndex = job.systemIndex;
+            m_readerPool.start([this, systemIndex, capture, first, count]() {
+                readBatch(systemIndex, capture, first, count);
+            });
+        }
+
+        // Drain this system's readers so its file count is final
+        m_readerPool.waitForDone();
+
+        if (!m_cancelled) {
+            const int reused = m_reusedFiles.exchange(0);
+            if (reused > 0) {
+                emit snapshotReused(job.systemIndex, reused);
+            }
+            if (!capture->snapshot.save(*capture->manifest, capture->hashes, capture->captured,
+                                        capture->captureTimeNs)) {
+                qWarning() << "Failed to save baseline snapshot for" << capture->manifest->root();
+            }
+            emit systemFinished(job.systemIndex, m_loadedFiles.exchange(0));
+        }
+    }
+
+    emit finished(m_cancelled);
+}
+
+void BaselineLoader::readBatch(int systemIndex, const std::shared_ptr<Capture>& capture,
+                               int first, int count)
+{
+    BaselineBatch files;
+    files.reserve(count);
+
+    int reused = 0;
+    const FileManifest& manifest = *capture->manifest;
+    const QVector<ManifestEntry>& entries = manifest.files();
+    for (int i = first; i < first + count; ++i) {
+        if (m_cancelled) {
+            return;
+        }
+
+        const ManifestEntry& entry = entries.at(i);
+        const QString filePath = manifest.absolutePath(entry.relativePath);
+
+        BaselineFile file;
+        file.relativePath = entry.relativePath;
+
+        // Files above the size cap are tracked by hash only, so a stray dump
+        // or media file is never loaded into memory
+        const bool keepContent = !capture->hashOnly &&
+            (capture->maxContentBytes <= 0 || entry.size <= capture->maxContentBytes);
+
+        // Unchanged since the last capture: reuse the hash, and leave the
+        // content in the snapshot pack until the file actually changes
+        const SnapshotEntry* recorded = capture->snapshot.findUnchanged(
+            entry.relativePath, entry.size, entry.mtimeNs, entry.inode);
+        if (recorded && (!keepContent || capture->snapshot.hasBlob(recorded->hash))) {
+            file.size = recorded->size;
+            file.hash = recorded->hash;
+            ++reused;
+        } else {
+            // Hash the mapped bytes in place; only kept content is copied.
+            // Without content to keep, an unmappable file is streamed.
+            MappedFile mapped(filePath, keepContent ? capture->maxContentBytes : MappedFileConfig::MAP_MIN_BYTES);
+            QByteArray data;
+            bool ok = false;
+            file.hash = mapped.fingerprint(capture->maxContentBytes, keepContent ? &data : nullptr, &ok);
+            if (!ok) {
+                continue;
+            }
+            file.size = mapped.size();
+            if (!data.isNull()) {
+                file.content = BlobStore::instance().intern(data, file.hash);
+                capture->snapshot.writeBlob(file.hash, data);
+            }
+        }
+
+        // Each reader owns a disjoint index range, so no locking is needed
+        capture->hashes[i] = file.hash;
+        capture->captured[i] = 1;
+        files.append(std::move(file));
+    }
+
+    m_loadedFiles += files.size();
+    m_reusedFiles += reused;
+    const int processed = (m_processedFiles += count);
+
+    emit batchLoaded(systemIndex, files);
+    emit progress(processed);
+}
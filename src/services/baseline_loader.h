@@ -0,0 +1,128 @@
+#ifndef BASELINE_LOADER_H
+#define BASELINE_LOADER_H
+
+#include <QObject>
+#include <QString>
+#include <QVector>
+#include <QFuture>
+#include <QThreadPool>
+#include <QMetaType>
+#include <atomic>
+#include <memory>
+
+#include "../core/exclusion_matcher.h"
+#include "../core/file_manifest.h"
+#include "../core/baseline_snapshot.h"
+#include "../core/blob_store.h"
+
+// Configuration constants
+namespace BaselineConfig {
+    constexpr int FILES_PER_BATCH = 256;
+}
+
+/**
+ * @brief One file read during baseline capture
+ */
+struct BaselineFile {
+    QString relativePath;
+    qint64 size = 0;
+    quint64 hash = 0;
+    // Null in hash-only mode and for files restored from the snapshot
+    BlobRef content;
+};
+
+using BaselineBatch = QVector<BaselineFile>;
+
+Q_DECLARE_METATYPE(BaselineFile)
+Q_DECLARE_METATYPE(BaselineBatch)
+
+/**
+ * @brief Captures baselines for one or more systems off the GUI thread
+ *
+ * A producer scans each source tree once into a FileManifest, reports the
+ * total, then hands batches of manifest entries to a pool of reader workers.
+ * Files unchanged since the persisted BaselineSnapshot reuse their recorded
+ * hash; the rest are read, fingerprinted and written back to the snapshot.
+ * Each worker delivers its batch to the owning thread through a queued
+ * signal, where it is merged into the per-system store. Progress and
+ * completion are reported the same way, and cancel() stops both the scan and
+ * the readers. The manifests stay available through jobs() for watch
+ * registration.
+ */
+class BaselineLoader : public QObject {
+    Q_OBJECT
+
+public:
+    struct Job {
+        int systemIndex = -1;
+        // Together with the source root, selects the persisted snapshot
+        QString systemName;
+        QString sourceRoot;
+        ExclusionMatcher exclusions;
+        // Keep only size and hash, not the decoded content
+        bool hashOnly = false;
+        // Larger files are tracked by hash only (0 = no cap)
+        qint64 maxContentBytes = 0;
+        // Filled in by the scan unless supplied by the caller
+        std::shared_ptr<const FileManifest> manifest;
+    };
+
+    explicit BaselineLoader(QObject* parent = nullptr);
+    ~BaselineLoader() override;
+
+    // Delete copy constructor and assignment operator
+    BaselineLoader(const BaselineLoader&) = delete;
+    BaselineLoader& operator=(const BaselineLoader&) = delete;
+
+    /**
+     * @brief Starts capturing all jobs; returns immediately
+     */
+    void start(const QVector<Job>& jobs);
+
+    /**
+     * @brief Requests cancellation; finished(true) follows
+     */
+    void cancel();
+
+    bool isRunning() const { return m_future.isRunning(); }
+
+    /**
+     * @brief Jobs with their scanned manifests; valid once finished() fired
+     */
+    QVector<Job> jobs() const { return m_jobs; }
+
+signals:
+    void systemScanned(int systemIndex, int fileCount);
+    void scanFinished(int totalFiles);
+    void batchLoaded(int systemIndex, const BaselineBatch& files);
+    void progress(int processedFiles);
+    void systemFinished(int systemIndex, int fileCount);
+    void snapshotReused(int systemIndex, int reusedFiles);
+    void finished(bool cancelled);
+
+private:
+    // Per-system state shared by the readers of one capture
+    struct Capture {
+        std::shared_ptr<const FileManifest> manifest;
+        BaselineSnapshot snapshot;
+        // Wall-clock start of reading, recorded for the racy-mtime check
+        qint64 captureTimeNs = 0;
+        std::vector<quint64> hashes;
+        std::vector<char> captured;
+        bool hashOnly = false;
+        qint64 maxContentBytes = 0;
+    };
+
+    void runJobs();
+    void readBatch(int systemIndex, const std::shared_ptr<Capture>& capture, int first, int count);
+
+    QVector<Job> m_jobs;
+    QThreadPool m_readerPool;
+    QFuture<void> m_future;
+    std::atomic<bool> m_cancelled;
+    std::atomic<int> m_processedFiles;
+    std::atomic<int> m_loadedFiles;
+    std::atomic<int> m_reusedFiles;
+};
+
+#endif // BASELINE_LOADER_H
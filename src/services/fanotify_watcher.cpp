@@ -0,0 +1,350 @@
+#include "fanotify_watcher.h"
+#include <QSocketNotifier>
+#include <QFile>
+#include <QFileInfo>
+
+#include <fcntl.h>
+#include <limits.h>
+#include <sys/fanotify.h>
+#include <sys/statfs.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+
+// Name reporting (Linux 5.9) is what makes a single filesystem mark usable
+#if defined(FAN_REPORT_DFID_NAME) && defined(FAN_EVENT_INFO_TYPE_DFID_NAME)
+#define HAVE_FANOTIFY_NAMES 1
+#endif
+
+namespace {
+#ifdef HAVE_FANOTIFY_NAMES
+    // Events we care about anywhere on a marked file system
+    constexpr uint64_t WATCH_MASK = FAN_MODIFY | FAN_CLOSE_WRITE | FAN_CREATE | FAN_DELETE | FAN_ONDIR;
+    constexpr uint64_t MOVE_MASK = FAN_MOVED_FROM | FAN_MOVED_TO;
+
+    inline QByteArray fsidKey(const void* fsid)
+    {
+        return QByteArray(static_cast<const char*>(fsid), int(sizeof(__kernel_fsid_t)));
+    }
+
+    // Resolving event handles needs CAP_DAC_READ_SEARCH; checked up front so
+    // a missing capability falls back instead of dropping every event
+    bool canResolveHandles(int mountFd)
+    {
+        struct {
+            struct file_handle handle;
+            unsigned char data[MAX_HANDLE_SZ];
+        } buffer;
+        buffer.handle.handle_bytes = MAX_HANDLE_SZ;
+        int mountId = 0;
+        if (::name_to_handle_at(mountFd, "", &buffer.handle, &mountId, AT_EMPTY_PATH) != 0) {
+            return false;
+        }
+
+        const int fd = ::open_by_handle_at(mountFd, &buffer.handle, O_PATH | O_CLOEXEC);
+        if (fd < 0) {
+            return false;
+        }
+        ::close(fd);
+        return true;
+    }
+#endif
+
+    inline QString errnoString(int error)
+    {
+        return QString::fromLocal8Bit(std::strerror(error));
+    }
+}
+
+FanotifyWatcher::FanotifyWatcher(QObject* parent)
+    : QObject(parent),
+      m_fd(-1),
+      m_notifier(nullptr),
+      m_reportsRenames(false)
+{
+#ifdef HAVE_FANOTIFY_NAMES
+    m_fd = fanotify_init(FAN_CLASS_NOTIF | FAN_CLOEXEC | FAN_NONBLOCK | FAN_REPORT_DFID_NAME,
+                         O_RDONLY | O_LARGEFILE);
+    if (m_fd < 0) {
+        const int error = errno;
+        if (error == EPERM) {
+            m_error = "fanotify needs CAP_SYS_ADMIN";
+        } else if (error == EINVAL) {
+            m_error = "kernel does not report file names through fanotify (needs Linux 5.9)";
+        } else {
+            m_error = errnoString(error);
+        }
+        return;
+    }
+
+    m_notifier = new QSocketNotifier(m_fd, QSocketNotifier::Read, this);
+    connect(m_notifier, &QSocketNotifier::activated, this, &FanotifyWatcher::readEvents);
+#else
+    m_error = "built without fanotify name reporting";
+#endif
+}
+
+FanotifyWatcher::~FanotifyWatcher()
+{
+    if (m_notifier) {
+        m_notifier->setEnabled(false);
+    }
+    for (auto it = m_mountFds.constBegin(); it != m_mountFds.constEnd(); ++it) {
+        ::close(it.value());
+    }
+    if (m_fd >= 0) {
+        // Closing the group removes its marks
+        ::close(m_fd);
+        m_fd = -1;
+    }
+}
+
+bool FanotifyWatcher::addFilesystem(const QString& path)
+{
+#ifdef HAVE_FANOTIFY_NAMES
+    if (m_fd < 0) {
+        return false;
+    }
+
+    const QByteArray encoded = QFile::encodeName(path);
+    struct statfs fs;
+    if (::statfs(encoded.constData(), &fs) != 0) {
+        m_error = errnoString(errno);
+        return false;
+    }
+
+    const QByteArray fsid = fsidKey(&fs.f_fsid);
+    if (m_mountFds.contains(fsid)) {
+        return true;
+    }
+
+    const int mountFd = ::open(encoded.constData(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (mountFd < 0) {
+        m_error = errnoString(errno);
+        return false;
+    }
+    if (!canResolveHandles(mountFd)) {
+        m_error = "resolving fanotify file handles needs CAP_DAC_READ_SEARCH";
+        ::close(mountFd);
+        return false;
+    }
+
+    // FAN_RENAME (Linux 5.17) reports both sides of a move in one event
+    bool marked = false;
+#ifdef FAN_RENAME
+    if (fanotify_mark(m_fd, FAN_MARK_ADD | FAN_MARK_FILESYSTEM, WATCH_MASK | FAN_RENAME,
+                      AT_FDCWD, encoded.constData()) == 0) {
+        marked = true;
+        m_reportsRenames = true;
+    }
+#endif
+    if (!marked && fanotify_mark(m_fd, FAN_MARK_ADD | FAN_MARK_FILESYSTEM, WATCH_MASK | MOVE_MASK,
+                                 AT_FDCWD, encoded.constData()) != 0) {
+        const int error = errno;
+        m_error = error == EXDEV
+            ? QString("%1 is a subvolume without its own fanotify file system id").arg(path)
+            : errnoString(error);
+        ::close(mountFd);
+        return false;
+    }
+
+    m_mountFds.insert(fsid, mountFd);
+    return true;
+#else
+    Q_UNUSED(path);
+    return false;
+#endif
+}
+
+QString FanotifyWatcher::resolveDirectory(const QByteArray& fsid, const void* handle)
+{
+#ifdef HAVE_FANOTIFY_NAMES
+    const auto* fileHandle = static_cast<const struct file_handle*>(handle);
+    const QByteArray key = fsid + QByteArray(static_cast<const char*>(handle),
+                                             int(sizeof(struct file_handle) + fileHandle->handle_bytes));
+
+    // Also answers for directories deleted since they were first seen, so
+    // the files removed along with them can still be reported
+    const auto cached = m_directoryCache.constFind(key);
+    if (cached != m_directoryCache.constEnd()) {
+        return cached.value();
+    }
+
+    const int mountFd = m_mountFds.value(fsid, -1);
+    if (mountFd < 0) {
+        return QString();
+    }
+
+    const int fd = ::open_by_handle_at(mountFd, const_cast<struct file_handle*>(fileHandle),
+                                       O_PATH | O_CLOEXEC);
+    if (fd < 0) {
+        return QString();
+    }
+
+    char target[PATH_MAX];
+    const QByteArray link = "/proc/self/fd/" + QByteArray::number(fd);
+    const ssize_t length = ::readlink(link.constData(), target, sizeof(target));
+    ::close(fd);
+    if (length <= 0) {
+        return QString();
+    }
+
+    const QString path = QFile::decodeName(QByteArray(target, int(length)));
+    if (m_directoryCache.size() >= FanotifyConfig::MAX_CACHED_DIRECTORIES) {
+        m_directoryCache.clear();
+    }
+    m_directoryCache.insert(key, path);
+    return path;
+#else
+    Q_UNUSED(fsid);
+    Q_UNUSED(handle);
+    return QString();
+#endif
+}
+
+void FanotifyWatcher::renameCachedDirectories(const QString& oldPath, const QString& newPath)
+{
+    const QString prefix = oldPath + QLatin1Char('/');
+    for (auto it = m_directoryCache.begin(); it != m_directoryCache.end(); ++it) {
+        if (it.value() == oldPath || it.value().startsWith(prefix)) {
+            it.value() = newPath + it.value().mid(oldPath.size());
+        }
+    }
+}
+
+void FanotifyWatcher::forgetCachedDirectories(const QString& path)
+{
+    const QString prefix = path + QLatin1Char('/');
+    for (auto it = m_directoryCache.begin(); it != m_directoryCache.end();) {
+        if (it.value() == path || it.value().startsWith(prefix)) {
+            it = m_directoryCache.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void FanotifyWatcher::readEvents()
+{
+#ifdef HAVE_FANOTIFY_NAMES
+    alignas(struct fanotify_event_metadata) char buffer[FanotifyConfig::EVENT_BUFFER_SIZE];
+
+    // Drain everything queued on the descriptor in as few reads as possible
+    for (;;) {
+        ssize_t length = ::read(m_fd, buffer, sizeof(buffer));
+        if (length <= 0) {
+            return;
+        }
+
+        auto* event = reinterpret_cast<struct fanotify_event_metadata*>(buffer);
+        for (; FAN_EVENT_OK(event, length); event = FAN_EVENT_NEXT(event, length)) {
+            if (event->vers != FANOTIFY_METADATA_VERSION) {
+                return;
+            }
+
+            if (event->mask & FAN_Q_OVERFLOW) {
+                // Renames may have been lost, so cached paths can be stale
+                m_directoryCache.clear();
+                emit eventQueueOverflow();
+                continue;
+            }
+
+            // Each name record is a parent directory handle plus an entry name
+            QString path;
+            QString oldPath;
+            const char* ptr = reinterpret_cast<const char*>(event) + event->metadata_len;
+            const char* end = reinterpret_cast<const char*>(event) + event->event_len;
+            while (ptr + sizeof(struct fanotify_event_info_header) <= end) {
+                const auto* header = reinterpret_cast<const struct fanotify_event_info_header*>(ptr);
+                if (header->len == 0) {
+                    break;
+                }
+
+                bool isOld = false;
+                bool isName = header->info_type == FAN_EVENT_INFO_TYPE_DFID_NAME;
+#ifdef FAN_RENAME
+                isOld = header->info_type == FAN_EVENT_INFO_TYPE_OLD_DFID_NAME;
+                isName = isName || isOld || header->info_type == FAN_EVENT_INFO_TYPE_NEW_DFID_NAME;
+#endif
+                if (isName) {
+                    const auto* info = reinterpret_cast<const struct fanotify_event_info_fid*>(ptr);
+                    const auto* handle = reinterpret_cast<const struct file_handle*>(info->handle);
+                    const char* name = reinterpret_cast<const char*>(handle->f_handle) + handle->handle_bytes;
+                    const QString dir = resolveDirectory(fsidKey(&info->fsid), handle);
+                    if (!dir.isEmpty()) {
+                        const QString entry = dir.endsWith(QLatin1Char('/'))
+                            ? dir + QFile::decodeName(name)
+                            : dir + QLatin1Char('/') + QFile::decodeName(name);
+                        (isOld ? oldPath : path) = entry;
+                    }
+                }
+                ptr += header->len;
+            }
+
+            const bool isDir = (event->mask & FAN_ONDIR) != 0;
+
+#ifdef FAN_RENAME
+            if (event->mask & FAN_RENAME) {
+                if (!oldPath.isEmpty() && !path.isEmpty()) {
+                    if (isDir) {
+                        renameCachedDirectories(oldPath, path);
+                        emit directoryRenamed(oldPath, path);
+                    } else {
+                        emit fileRenamed(oldPath, path);
+                    }
+                } else if (!path.isEmpty()) {
+                    // The old parent could not be resolved any more
+                    if (isDir) {
+                        emit directoryMovedIn(path);
+                    } else {
+                        emit fileCreated(path);
+                    }
+                } else if (!oldPath.isEmpty()) {
+                    if (isDir) {
+                        forgetCachedDirectories(oldPath);
+                        emit directoryDeleted(oldPath);
+                    } else {
+                        emit fileDeleted(oldPath);
+                    }
+                }
+                continue;
+            }
+#endif
+
+            if (path.isEmpty()) {
+                continue;
+            }
+
+            // Without FAN_RENAME the two halves of a directory move cannot be
+            // paired, so the new path is unknown; drop the cached paths of the
+            // moved tree instead and resolve its handles afresh. A deleted
+            // directory keeps them, its files were reported before it.
+            if (isDir && (event->mask & (FAN_MOVED_FROM | FAN_MOVED_TO))) {
+                forgetCachedDirectories(path);
+            }
+
+            // The kernel merges queued events for the same entry, so one
+            // event can carry both a creation and a removal
+            const bool removed = (event->mask & (FAN_DELETE | FAN_MOVED_FROM)) != 0;
+            const bool added = (event->mask & (FAN_CREATE | FAN_MOVED_TO)) != 0;
+            if (removed && (!added || !QFileInfo::exists(path))) {
+                if (isDir) {
+                    emit directoryDeleted(path);
+                } else {
+                    emit fileDeleted(path);
+                }
+            } else if (added) {
+                if (!isDir) {
+                    emit fileCreated(path);
+                } else if (event->mask & FAN_MOVED_TO) {
+                    emit directoryMovedIn(path);
+                } else {
+                    emit directoryCreated(path);
+                }
+            } else if (!isDir && (event->mask & (FAN_MODIFY | FAN_CLOSE_WRITE))) {
+                emit fileModified(path);
+            }
+        }
+    }
+#endif
+}
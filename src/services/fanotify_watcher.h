@@ -0,0 +1,104 @@
+#ifndef FANOTIFY_WATCHER_H
+#define FANOTIFY_WATCHER_H
+
+#include <QObject>
+#include <QString>
+#include <QByteArray>
+#include <QHash>
+
+class QSocketNotifier;
+
+// Configuration constants
+namespace FanotifyConfig {
+    constexpr int EVENT_BUFFER_SIZE = 64 * 1024;
+    // Resolved directory handles kept before the cache is started over
+    constexpr int MAX_CACHED_DIRECTORIES = 65536;
+}
+
+/**
+ * @brief Linux whole-filesystem watcher built on fanotify
+ *
+ * One FAN_MARK_FILESYSTEM mark covers every directory of a mounted file
+ * system, so setup takes constant time however large the tree is and new
+ * directories need no registration. Events carry the parent directory as a
+ * file handle plus the entry name (FAN_REPORT_DFID_NAME); handles are
+ * resolved to paths with open_by_handle_at() and cached. Where the kernel
+ * supports FAN_RENAME both sides of a move arrive in one event and are
+ * reported as a rename, otherwise as a deletion and a creation.
+ *
+ * Requires Linux 5.9 or newer and CAP_SYS_ADMIN plus CAP_DAC_READ_SEARCH;
+ * isValid() and addFilesystem() report whether it can be used, so callers
+ * can fall back to inotify. Events for the whole file system are reported,
+ * callers filter them by path. Must be created and used in the thread that
+ * owns its event loop.
+ */
+class FanotifyWatcher : public QObject {
+    Q_OBJECT
+
+public:
+    explicit FanotifyWatcher(QObject* parent = nullptr);
+    ~FanotifyWatcher() override;
+
+    // Delete copy constructor and assignment operator
+    FanotifyWatcher(const FanotifyWatcher&) = delete;
+    FanotifyWatcher& operator=(const FanotifyWatcher&) = delete;
+
+    /**
+     * @brief Checks whether the fanotify group was created successfully
+     */
+    bool isValid() const { return m_fd >= 0; }
+
+    /**
+     * @brief Why the watcher or its last mark could not be set up
+     */
+    QString errorString() const { return m_error; }
+
+    /**
+     * @brief Marks the whole file system containing path
+     * @return true if path's file system is watched, also when it already was
+     */
+    bool addFilesystem(const QString& path);
+
+    /**
+     * @brief Whether moves arrive as renames (FAN_RENAME) rather than as a
+     * deletion and a creation
+     */
+    bool reportsRenames() const { return m_reportsRenames; }
+
+    /**
+     * @brief Number of file systems marked
+     */
+    int filesystemCount() const { return m_mountFds.size(); }
+
+signals:
+    void fileModified(const QString& filePath);
+    void fileCreated(const QString& filePath);
+    void fileDeleted(const QString& filePath);
+    void directoryCreated(const QString& dirPath);
+    // A directory moved in from elsewhere; its contents were not reported
+    void directoryMovedIn(const QString& dirPath);
+    void directoryDeleted(const QString& dirPath);
+    void fileRenamed(const QString& oldPath, const QString& newPath);
+    void directoryRenamed(const QString& oldPath, const QString& newPath);
+    void eventQueueOverflow();
+
+private slots:
+    void readEvents();
+
+private:
+    QString resolveDirectory(const QByteArray& fsid, const void* handle);
+    void renameCachedDirectories(const QString& oldPath, const QString& newPath);
+    // Drops cached paths at or below path, so their handles are resolved again
+    void forgetCachedDirectories(const QString& path);
+
+    int m_fd;
+    QSocketNotifier* m_notifier;
+    bool m_reportsRenames;
+    QString m_error;
+    // Open directory on each marked file system by fsid, for open_by_handle_at
+    QHash<QByteArray, int> m_mountFds;
+    // Directory paths by fsid plus file handle
+    QHash<QByteArray, QString> m_directoryCache;
+};
+
+#endif // FANOTIFY_WATCHER_H
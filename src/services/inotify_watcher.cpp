@@ -0,0 +1,245 @@
+#include "inotify_watcher.h"
+#include <QSocketNotifier>
+#include <QTimer>
+#include <QFile>
+#include <QByteArray>
+#include <QList>
+
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <utility>
+
+namespace {
+    // Events we care about on every watched directory
+    constexpr uint32_t WATCH_MASK = IN_MODIFY | IN_CLOSE_WRITE | IN_CREATE | IN_DELETE |
+                                    IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF |
+                                    IN_ONLYDIR | IN_EXCL_UNLINK;
+}
+
+InotifyWatcher::InotifyWatcher(QObject* parent)
+    : QObject(parent),
+      m_fd(inotify_init1(IN_NONBLOCK | IN_CLOEXEC)),
+      m_notifier(nullptr),
+      m_moveTimer(new QTimer(this))
+{
+    m_moveTimer->setSingleShot(true);
+    connect(m_moveTimer, &QTimer::timeout, this, &InotifyWatcher::flushExpiredMoves);
+
+    if (m_fd < 0) {
+        return;
+    }
+
+    m_notifier = new QSocketNotifier(m_fd, QSocketNotifier::Read, this);
+    connect(m_notifier, &QSocketNotifier::activated, this, &InotifyWatcher::readEvents);
+}
+
+InotifyWatcher::~InotifyWatcher()
+{
+    if (m_notifier) {
+        m_notifier->setEnabled(false);
+    }
+    if (m_fd >= 0) {
+        // Closing the descriptor releases every watch at once
+        ::close(m_fd);
+        m_fd = -1;
+    }
+}
+
+bool InotifyWatcher::addDirectory(const QString& path)
+{
+    if (m_fd < 0 || m_pathToWd.contains(path)) {
+        return false;
+    }
+
+    const QByteArray encoded = QFile::encodeName(path);
+    const int wd = inotify_add_watch(m_fd, encoded.constData(), WATCH_MASK);
+    if (wd < 0) {
+        return false;
+    }
+
+    // The kernel returns the existing descriptor for an inode that is already
+    // watched (e.g. reached through a bind mount), keep the first path for it
+    if (m_wdToPath.contains(wd)) {
+        return false;
+    }
+
+    m_wdToPath.insert(wd, path);
+    m_pathToWd.insert(path, wd);
+    return true;
+}
+
+void InotifyWatcher::removeDirectory(const QString& path)
+{
+    // Collect the directory and every watched directory below it; after a
+    // move their stored paths are stale and must not be reported again
+    const QString prefix = path + QLatin1Char('/');
+    QList<int> stale;
+    for (auto it = m_pathToWd.constBegin(); it != m_pathToWd.constEnd(); ++it) {
+        if (it.key() == path || it.key().startsWith(prefix)) {
+            stale.append(it.value());
+        }
+    }
+
+    for (int wd : stale) {
+        inotify_rm_watch(m_fd, wd);
+        forgetWatch(wd);
+    }
+}
+
+void InotifyWatcher::forgetWatch(int wd)
+{
+    const auto it = m_wdToPath.find(wd);
+    if (it == m_wdToPath.end()) {
+        return;
+    }
+    m_pathToWd.remove(it.value());
+    m_wdToPath.erase(it);
+}
+
+void InotifyWatcher::renameWatches(const QString& oldPath, const QString& newPath)
+{
+    // The kernel keeps the watches on the moved inodes, only the paths we
+    // report for them change
+    const QString prefix = oldPath + QLatin1Char('/');
+    QList<int> moved;
+    for (auto it = m_pathToWd.constBegin(); it != m_pathToWd.constEnd(); ++it) {
+        if (it.key() == oldPath || it.key().startsWith(prefix)) {
+            moved.append(it.value());
+        }
+    }
+
+    for (int wd : moved) {
+        const QString oldWatchPath = m_wdToPath.value(wd);
+        const QString newWatchPath = newPath + oldWatchPath.mid(oldPath.size());
+        m_pathToWd.remove(oldWatchPath);
+        m_pathToWd.insert(newWatchPath, wd);
+        m_wdToPath.insert(wd, newWatchPath);
+    }
+}
+
+void InotifyWatcher::scheduleMoveFlush()
+{
+    if (m_pendingMoves.isEmpty()) {
+        m_moveTimer->stop();
+        return;
+    }
+
+    qint64 remaining = InotifyConfig::MOVE_PAIR_GRACE_MS;
+    for (const PendingMove& move : std::as_const(m_pendingMoves)) {
+        remaining = qMin(remaining, move.deadline.remainingTime());
+    }
+    m_moveTimer->start(int(qMax<qint64>(remaining, 0)));
+}
+
+void InotifyWatcher::flushExpiredMoves()
+{
+    // A move whose other half did not arrive in time left the watched tree
+    QList<PendingMove> expired;
+    for (auto it = m_pendingMoves.begin(); it != m_pendingMoves.end();) {
+        if (it.value().deadline.hasExpired()) {
+            expired.append(it.value());
+            it = m_pendingMoves.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    for (const PendingMove& move : expired) {
+        if (move.isDir) {
+            removeDirectory(move.path);
+            emit directoryDeleted(move.path);
+        } else {
+            emit fileDeleted(move.path);
+        }
+    }
+    scheduleMoveFlush();
+}
+
+void InotifyWatcher::readEvents()
+{
+    alignas(struct inotify_event) char buffer[InotifyConfig::EVENT_BUFFER_SIZE];
+
+    // Drain everything queued on the descriptor in as few reads as possible
+    for (;;) {
+        const ssize_t length = ::read(m_fd, buffer, sizeof(buffer));
+        if (length <= 0) {
+            // EAGAIN: queue drained; anything else: nothing more we can do now.
+            // A move still unmatched here may be completed by the next read
+            scheduleMoveFlush();
+            return;
+        }
+
+        const char* ptr = buffer;
+        const char* end = buffer + length;
+        while (ptr < end) {
+            const auto* event = reinterpret_cast<const struct inotify_event*>(ptr);
+            ptr += sizeof(struct inotify_event) + event->len;
+
+            if (event->mask & IN_Q_OVERFLOW) {
+                emit eventQueueOverflow();
+                continue;
+            }
+
+            if (event->mask & IN_IGNORED) {
+                // Watch was removed (directory deleted or unmounted)
+                forgetWatch(event->wd);
+                continue;
+            }
+
+            const auto dirIt = m_wdToPath.constFind(event->wd);
+            if (dirIt == m_wdToPath.constEnd()) {
+                continue;
+            }
+            const QString dirPath = dirIt.value();
+
+            if (event->mask & IN_DELETE_SELF) {
+                continue;
+            }
+
+            if (event->len == 0) {
+                continue;
+            }
+
+            const QString path = dirPath + QLatin1Char('/') + QFile::decodeName(event->name);
+            const bool isDir = (event->mask & IN_ISDIR) != 0;
+
+            if (event->mask & IN_MOVED_FROM) {
+                m_pendingMoves.insert(event->cookie,
+                    PendingMove{path, isDir, QDeadlineTimer(InotifyConfig::MOVE_PAIR_GRACE_MS)});
+                continue;
+            }
+
+            if (event->mask & IN_MOVED_TO) {
+                const auto moveIt = m_pendingMoves.find(event->cookie);
+                if (moveIt != m_pendingMoves.end()) {
+                    const PendingMove move = moveIt.value();
+                    m_pendingMoves.erase(moveIt);
+                    if (isDir) {
+                        renameWatches(move.path, path);
+                        emit directoryRenamed(move.path, path);
+                    } else {
+                        emit fileRenamed(move.path, path);
+                    }
+                    continue;
+                }
+            }
+
+            if (event->mask & (IN_CREATE | IN_MOVED_TO)) {
+                if (isDir) {
+                    emit directoryCreated(path);
+                } else {
+                    emit fileCreated(path);
+                }
+            } else if (event->mask & IN_DELETE) {
+                if (isDir) {
+                    removeDirectory(path);
+                    emit directoryDeleted(path);
+                } else {
+                    emit fileDeleted(path);
+                }
+            } else if (!isDir && (event->mask & (IN_MODIFY | IN_CLOSE_WRITE))) {
+                emit fileModified(path);
+            }
+        }
+    }
+}
@@ -0,0 +1,105 @@
+#ifndef INOTIFY_WATCHER_H
+#define INOTIFY_WATCHER_H
+
+#include <QObject>
+#include <QString>
+#include <QHash>
+#include <QDeadlineTimer>
+
+class QSocketNotifier;
+class QTimer;
+
+// Configuration constants
+namespace InotifyConfig {
+    constexpr int EVENT_BUFFER_SIZE = 64 * 1024;
+    // How long an IN_MOVED_FROM waits for its IN_MOVED_TO; the kernel
+    // queues both halves together, but they can land in separate reads
+    constexpr int MOVE_PAIR_GRACE_MS = 50;
+}
+
+/**
+ * @brief Linux-native directory watcher built on raw inotify
+ *
+ * Watches directories only (one watch descriptor per directory instead of
+ * one per file) and reads all pending events from a single descriptor in
+ * bulk. IN_MOVED_FROM/IN_MOVED_TO pairs are matched by cookie and reported
+ * as renames; a move with only one side inside the watched tree is reported
+ * as a deletion or creation. An unmatched IN_MOVED_FROM is held for a
+ * short grace period, since its IN_MOVED_TO may only arrive with the next
+ * read, and reported as a deletion once that runs out. Must be created and
+ * used in the thread that owns its event loop.
+ */
+class InotifyWatcher : public QObject {
+    Q_OBJECT
+
+public:
+    explicit InotifyWatcher(QObject* parent = nullptr);
+    ~InotifyWatcher() override;
+
+    // Delete copy constructor and assignment operator
+    InotifyWatcher(const InotifyWatcher&) = delete;
+    InotifyWatcher& operator=(const InotifyWatcher&) = delete;
+
+    /**
+     * @brief Checks whether the inotify instance was created successfully
+     */
+    bool isValid() const { return m_fd >= 0; }
+
+    /**
+     * @brief Adds a watch for a single directory (not recursive)
+     * @return true if a new watch was registered
+     */
+    bool addDirectory(const QString& path);
+
+    /**
+     * @brief Removes the watch for a directory and every watched directory below it
+     */
+    void removeDirectory(const QString& path);
+
+    /**
+     * @brief Checks whether a directory is already watched
+     */
+    bool isWatching(const QString& path) const { return m_pathToWd.contains(path); }
+
+    /**
+     * @brief Number of directory watches currently registered
+     */
+    int watchCount() const { return m_wdToPath.size(); }
+
+signals:
+    void fileModified(const QString& filePath);
+    void fileCreated(const QString& filePath);
+    void fileDeleted(const QString& filePath);
+    void directoryCreated(const QString& dirPath);
+    void directoryDeleted(const QString& dirPath);
+    void fileRenamed(const QString& oldPath, const QString& newPath);
+    // Watches below the directory already follow it to the new path
+    void directoryRenamed(const QString& oldPath, const QString& newPath);
+    void eventQueueOverflow();
+
+private slots:
+    void readEvents();
+    void flushExpiredMoves();
+
+private:
+    struct PendingMove {
+        QString path;
+        bool isDir = false;
+        QDeadlineTimer deadline;
+    };
+
+    void forgetWatch(int wd);
+    void renameWatches(const QString& oldPath, const QString& newPath);
+    // Arms m_moveTimer for the earliest pending move, if any
+    void scheduleMoveFlush();
+
+    int m_fd;
+    QSocketNotifier* m_notifier;
+    QTimer* m_moveTimer;
+    QHash<int, QString> m_wdToPath;
+    QHash<QString, int> m_pathToWd;
+    // IN_MOVED_FROM events waiting for their IN_MOVED_TO, by cookie
+    QHash<quint32, PendingMove> m_pendingMoves;
+};
+
+#endif // INOTIFY_WATCHER_H
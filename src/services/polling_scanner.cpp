@@ -0,0 +1,450 @@
+#include "polling_scanner.h"
+#include "../core/file_manifest.h"
+#include <QtConcurrent/QtConcurrent>
+#include <QDateTime>
+#include <QDir>
+#include <QDirIterator>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QSet>
+
+#ifdef Q_OS_UNIX
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#endif
+
+namespace {
+    struct PathStat {
+        bool exists = false;
+        bool isDir = false;
+        bool isFile = false;
+        quint64 inode = 0;
+        qint64 size = 0;
+        qint64 mtimeNs = 0;
+    };
+
+    inline bool isCancelled(const std::atomic<bool>* cancelled)
+    {
+        return cancelled && cancelled->load(std::memory_order_relaxed);
+    }
+
+#ifdef Q_OS_UNIX
+    inline qint64 modificationTimeNs(const struct stat& st)
+    {
+#if defined(Q_OS_DARWIN)
+        return qint64(st.st_mtimespec.tv_sec) * 1000000000LL + st.st_mtimespec.tv_nsec;
+#elif defined(Q_OS_LINUX)
+        return qint64(st.st_mtim.tv_sec) * 1000000000LL + st.st_mtim.tv_nsec;
+#else
+        return qint64(st.st_mtime) * 1000000000LL;
+#endif
+    }
+
+    inline PathStat fromStat(const struct stat& st)
+    {
+        PathStat result;
+        result.exists = true;
+        result.isDir = S_ISDIR(st.st_mode);
+        result.isFile = S_ISREG(st.st_mode);
+        result.inode = st.st_ino;
+        result.size = st.st_size;
+        result.mtimeNs = modificationTimeNs(st);
+        return result;
+    }
+
+    PathStat statPath(const QString& path)
+    {
+        struct stat st;
+        if (::lstat(QFile::encodeName(path).constData(), &st) != 0) {
+            return PathStat();
+        }
+        return fromStat(st);
+    }
+#else
+    PathStat statPath(const QString& path)
+    {
+        const QFileInfo info(path);
+        PathStat result;
+        if (!info.exists() || info.isSymLink()) {
+            return result;
+        }
+        result.exists = true;
+        result.isDir = info.isDir();
+        result.isFile = info.isFile();
+        result.size = info.size();
+        result.mtimeNs = info.lastModified().toMSecsSinceEpoch() * 1000000LL;
+        return result;
+    }
+#endif
+}
+
+PollingScanner::PollingScanner(const QString& root, const ExclusionMatcher& exclusions)
+    : m_root(QDir::cleanPath(root)),
+      m_exclusions(exclusions)
+{
+    m_directories.insert(m_root, DirectoryState());
+}
+
+void PollingScanner::seed(const FileManifest& manifest)
+{
+    m_directories.clear();
+    m_fileCount = 0;
+    m_directories.insert(m_root, DirectoryState());
+
+    // Parents are listed before their children in the manifest
+    for (const QString& dir : manifest.directories()) {
+        m_directories[manifest.absolutePath(dir)];
+        const int slash = dir.lastIndexOf(QLatin1Char('/'));
+        const QString parent = slash < 0 ? m_root : manifest.absolutePath(dir.left(slash));
+        m_directories[parent].subdirectories << dir.mid(slash + 1);
+    }
+
+    for (const ManifestEntry& file : manifest.files()) {
+        const int slash = file.relativePath.lastIndexOf(QLatin1Char('/'));
+        const QString parent = slash < 0 ? m_root : manifest.absolutePath(file.relativePath.left(slash));
+
+        FileStamp stamp;
+        stamp.inode = file.inode;
+        stamp.size = file.size;
+        stamp.mtimeNs = file.mtimeNs;
+        m_directories[parent].files.insert(file.relativePath.mid(slash + 1), stamp);
+        ++m_fileCount;
+    }
+    m_seeded = true;
+}
+
+FileEventBatch PollingScanner::scan(QThreadPool* pool, const std::atomic<bool>* cancelled)
+{
+    QElapsedTimer timer;
+    timer.start();
+    ScanStats stats;
+
+    // Directories modified this recently may still change within the same
+    // mtime tick, so they are listed again on the next scan
+    const qint64 settledBeforeNs =
+        (QDateTime::currentMSecsSinceEpoch() - PollingConfig::RACY_WINDOW_MS) * 1000000LL;
+
+    QVector<PathChange> created;
+    QVector<PathChange> deleted;
+    QStringList changed;
+
+    // New directories found by one wave are checked by the next
+    QStringList wave = m_directories.keys();
+    while (!wave.isEmpty() && !isCancelled(cancelled)) {
+        const QVector<DirectoryDelta> deltas = QtConcurrent::blockingMapped<QVector<DirectoryDelta>>(
+            pool, wave, [this, cancelled](const QString& path) {
+                return checkDirectory(path, cancelled);
+            });
+
+        QStringList next;
+        for (const DirectoryDelta& delta : deltas) {
+            ++stats.directoriesChecked;
+            stats.filesChecked += delta.filesChecked;
+
+            auto it = m_directories.find(delta.path);
+            if (it == m_directories.end()) {
+                // Removed together with its parent earlier in this wave
+                continue;
+            }
+            if (delta.gone) {
+                removeTree(delta.path, &deleted);
+                if (delta.path == m_root) {
+                    // Keep checking the root so its return is noticed
+                    m_directories.insert(m_root, DirectoryState());
+                }
+                continue;
+            }
+
+            DirectoryState& state = it.value();
+            const QString prefix = delta.path + QLatin1Char('/');
+            for (const FileChange& change : delta.changed) {
+                state.files[change.name] = change.stamp;
+                changed << prefix + change.name;
+            }
+            for (const QString& name : delta.deleted) {
+                PathChange removed;
+                removed.path = prefix + name;
+                removed.stamp = state.files.take(name);
+                deleted.append(removed);
+                --m_fileCount;
+            }
+            for (const FileChange& change : delta.created) {
+                state.files.insert(change.name, change.stamp);
+                PathChange added;
+                added.path = prefix + change.name;
+                added.stamp = change.stamp;
+                created.append(added);
+                ++m_fileCount;
+            }
+
+            QStringList removedDirectories;
+            QStringList addedDirectories;
+            if (delta.listed) {
+                ++stats.directoriesListed;
+                if (state.subdirectories != delta.subdirectories) {
+                    const QSet<QString> before(state.subdirectories.cbegin(), state.subdirectories.cend());
+                    const QSet<QString> after(delta.subdirectories.cbegin(), delta.subdirectories.cend());
+                    for (const QString& name : state.subdirectories) {
+                        if (!after.contains(name)) {
+                            removedDirectories << prefix + name;
+                        }
+                    }
+                    for (const QString& name : delta.subdirectories) {
+                        if (!before.contains(name)) {
+                            addedDirectories << prefix + name;
+                        }
+                    }
+                    state.subdirectories = delta.subdirectories;
+                }
+            }
+            state.mtimeNs = delta.mtimeNs >= settledBeforeNs ? -1 : delta.mtimeNs;
+
+            // The hash is only modified once state is no longer used
+            for (const QString& path : removedDirectories) {
+                removeTree(path, &deleted);
+            }
+            for (const QString& path : addedDirectories) {
+                if (!m_directories.contains(path)) {
+                    m_directories.insert(path, DirectoryState());
+                    next << path;
+                }
+            }
+        }
+        wave = next;
+    }
+
+    stats.durationMs = timer.elapsed();
+    m_lastScan = stats;
+
+    // Without a seed the first scan only builds the index
+    if (!m_seeded) {
+        m_seeded = true;
+        return FileEventBatch();
+    }
+
+    // A file that left one place and showed up unchanged in another moved
+    QHash<quint64, int> deletedByInode;
+    for (int i = 0; i < deleted.size(); ++i) {
+        if (deleted[i].stamp.inode != 0) {
+            deletedByInode.insert(deleted[i].stamp.inode, i);
+        }
+    }
+
+    QVector<bool> moved(deleted.size(), false);
+    FileEventBatch renames;
+    FileEventBatch creations;
+    for (const PathChange& added : created) {
+        const auto it = added.stamp.inode != 0 ? deletedByInode.constFind(added.stamp.inode)
+                                               : deletedByInode.constEnd();
+        if (it != deletedByInode.constEnd() && !moved[it.value()] &&
+            deleted[it.value()].stamp == added.stamp) {
+            moved[it.value()] = true;
+            FileEvent event;
+            event.path = added.path;
+            event.oldPath = deleted[it.value()].path;
+            event.kind = FileEvent::Kind::Renamed;
+            renames.append(event);
+            continue;
+        }
+
+        FileEvent event;
+        event.path = added.path;
+        event.kind = FileEvent::Kind::Created;
+        creations.append(event);
+    }
+
+    FileEventBatch events;
+    events.reserve(deleted.size() + created.size() + changed.size());
+    for (int i = 0; i < deleted.size(); ++i) {
+        if (!moved[i]) {
+            FileEvent event;
+            event.path = deleted[i].path;
+            event.kind = FileEvent::Kind::Deleted;
+            events.append(event);
+        }
+    }
+    events += renames;
+    events += creations;
+    for (const QString& path : changed) {
+        FileEvent event;
+        event.path = path;
+        event.kind = FileEvent::Kind::Changed;
+        events.append(event);
+    }
+    return events;
+}
+
+PollingScanner::DirectoryDelta PollingScanner::checkDirectory(const QString& path,
+                                                              const std::atomic<bool>* cancelled) const
+{
+    DirectoryDelta delta;
+    delta.path = path;
+
+    const auto it = m_directories.constFind(path);
+    const DirectoryState* state = it == m_directories.constEnd() ? nullptr : &it.value();
+    if (isCancelled(cancelled)) {
+        // Left as it was and checked again next time
+        delta.mtimeNs = state ? state->mtimeNs : -1;
+        return delta;
+    }
+
+    const PathStat dir = statPath(path);
+    if (!dir.exists || !dir.isDir) {
+        delta.gone = true;
+        return delta;
+    }
+    delta.mtimeNs = dir.mtimeNs;
+
+    if (!state || state->mtimeNs != dir.mtimeNs) {
+        delta.listed = true;
+        listDirectory(state, &delta);
+        return delta;
+    }
+
+    // Same listing as before; in-place writes only show on the files
+    const QString prefix = path + QLatin1Char('/');
+    for (auto file = state->files.constBegin(); file != state->files.constEnd(); ++file) {
+        ++delta.filesChecked;
+        const PathStat st = statPath(prefix + file.key());
+        if (!st.exists || !st.isFile) {
+            delta.deleted << file.key();
+            continue;
+        }
+
+        FileStamp stamp;
+        stamp.inode = st.inode;
+        stamp.size = st.size;
+        stamp.mtimeNs = st.mtimeNs;
+        if (stamp != file.value()) {
+            FileChange change;
+            change.name = file.key();
+            change.stamp = stamp;
+            delta.changed.append(change);
+        }
+    }
+
+    if (!delta.deleted.isEmpty()) {
+        // The listing changed within one mtime tick; list it next time
+        delta.mtimeNs = -1;
+    }
+    delta.subdirectories = state->subdirectories;
+    return delta;
+}
+
+void PollingScanner::listDirectory(const DirectoryState* state, DirectoryDelta* delta) const
+{
+    QSet<QString> present;
+    int matched = 0;
+    const QString prefix = delta->path + QLatin1Char('/');
+
+    auto addFile = [&](const QString& name, const FileStamp& stamp) {
+        ++delta->filesChecked;
+        present.insert(name);
+        FileChange change;
+        change.name = name;
+        change.stamp = stamp;
+
+        const auto previous = state ? state->files.constFind(name) : QHash<QString, FileStamp>::const_iterator();
+        if (!state || previous == state->files.constEnd()) {
+            delta->created.append(change);
+            return;
+        }
+        ++matched;
+        if (previous.value() != stamp) {
+            delta->changed.append(change);
+        }
+    };
+
+#ifdef Q_OS_UNIX
+    // One fstatat() per entry, as in the startup scan
+    DIR* dir = ::opendir(QFile::encodeName(delta->path).constData());
+    if (!dir) {
+        delta->gone = true;
+        return;
+    }
+    const int dirFd = ::dirfd(dir);
+
+    while (struct dirent* entry = ::readdir(dir)) {
+        // Skips ".", ".." and hidden entries, matching QDir without QDir::Hidden
+        if (entry->d_name[0] == '.' || entry->d_type == DT_LNK) {
+            continue;
+        }
+
+        struct stat st;
+        if (::fstatat(dirFd, entry->d_name, &st, AT_SYMLINK_NOFOLLOW) != 0) {
+            continue;
+        }
+
+        const QString name = QFile::decodeName(entry->d_name);
+        if (S_ISDIR(st.st_mode)) {
+            if (!m_exclusions.isDirectoryExcluded(prefix + name)) {
+                delta->subdirectories << name;
+            }
+        } else if (S_ISREG(st.st_mode)) {
+            if (m_exclusions.isExcluded(prefix + name)) {
+                continue;
+            }
+            const PathStat file = fromStat(st);
+            FileStamp stamp;
+            stamp.inode = file.inode;
+            stamp.size = file.size;
+            stamp.mtimeNs = file.mtimeNs;
+            addFile(name, stamp);
+        }
+    }
+
+    ::closedir(dir);
+#else
+    QDirIterator it(delta->path, QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot | QDir::NoSymLinks);
+    while (it.hasNext()) {
+        const QString path = it.next();
+        const QFileInfo info = it.fileInfo();
+        if (info.isDir()) {
+            if (!m_exclusions.isDirectoryExcluded(path)) {
+                delta->subdirectories << info.fileName();
+            }
+        } else if (!m_exclusions.isExcluded(path)) {
+            FileStamp stamp;
+            stamp.size = info.size();
+            stamp.mtimeNs = info.lastModified().toMSecsSinceEpoch() * 1000000LL;
+            addFile(info.fileName(), stamp);
+        }
+    }
+#endif
+
+    if (state && matched != state->files.size()) {
+        for (auto file = state->files.constBegin(); file != state->files.constEnd(); ++file) {
+            if (!present.contains(file.key())) {
+                delta->deleted << file.key();
+            }
+        }
+    }
+}
+
+void PollingScanner::removeTree(const QString& path, QVector<PathChange>* deleted)
+{
+    QStringList pending;
+    pending << path;
+    while (!pending.isEmpty()) {
+        const QString dir = pending.takeLast();
+        auto it = m_directories.find(dir);
+        if (it == m_directories.end()) {
+            continue;
+        }
+
+        const QString prefix = dir + QLatin1Char('/');
+        for (auto file = it->files.constBegin(); file != it->files.constEnd(); ++file) {
+            PathChange removed;
+            removed.path = prefix + file.key();
+            removed.stamp = file.value();
+            deleted->append(removed);
+            --m_fileCount;
+        }
+        for (const QString& name : it->subdirectories) {
+            pending << prefix + name;
+        }
+        m_directories.erase(it);
+    }
+}
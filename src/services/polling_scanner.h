@@ -0,0 +1,134 @@
+#ifndef POLLING_SCANNER_H
+#define POLLING_SCANNER_H
+
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <atomic>
+
+#include "../core/exclusion_matcher.h"
+#include "../core/file_event.h"
+
+class FileManifest;
+class QThreadPool;
+
+// Configuration constants
+namespace PollingConfig {
+    constexpr int DEFAULT_INTERVAL_MS = 2000;
+    constexpr int MIN_INTERVAL_MS = 250;
+    // Directory checks are latency bound on network mounts, so more of them
+    // run at once than there are cores
+    constexpr int MAX_PARALLEL_DIRECTORIES = 16;
+    // Directories modified this recently are listed again on the next scan,
+    // covering file systems with coarse mtime resolution
+    constexpr qint64 RACY_WINDOW_MS = 2000;
+}
+
+/**
+ * @brief Detects changes below a root by periodically stat'ing it
+ *
+ * For file systems that deliver no change notifications, such as SMB and
+ * NFS mounts. Keeps a compact index of every directory (its mtime and
+ * subdirectories) and every file (inode, size, mtime in nanoseconds). A
+ * scan checks all directories in parallel; only directories whose mtime
+ * moved are listed again, the files of the others are stat'ed one by one
+ * since writing a file in place does not touch its directory. A file that
+ * disappears while another with the same inode, size and mtime appears is
+ * reported as a rename; without inode numbers (Windows) it is reported as a
+ * deletion and a creation.
+ *
+ * Not thread-safe; scan() must not overlap with itself or seed().
+ */
+class PollingScanner {
+public:
+    /**
+     * @brief Counters of the most recent scan
+     */
+    struct ScanStats {
+        qint64 durationMs = 0;
+        int directoriesChecked = 0;
+        int directoriesListed = 0;
+        int filesChecked = 0;
+    };
+
+    PollingScanner(const QString& root, const ExclusionMatcher& exclusions);
+
+    /**
+     * @brief Fills the index from the startup scan instead of walking the tree
+     *
+     * Directory mtimes are not part of the manifest, so the first scan lists
+     * every directory once and reports what changed since the manifest.
+     */
+    void seed(const FileManifest& manifest);
+
+    /**
+     * @brief Compares the tree with the index and updates it
+     * @param pool Pool the directory checks run on
+     * @param cancelled Optional flag polled between directories
+     * @return Events in the order deletions, renames, creations, changes
+     */
+    FileEventBatch scan(QThreadPool* pool, const std::atomic<bool>* cancelled = nullptr);
+
+    const ScanStats& lastScan() const { return m_lastScan; }
+    const QString& root() const { return m_root; }
+    int directoryCount() const { return m_directories.size(); }
+    int fileCount() const { return m_fileCount; }
+
+private:
+    struct FileStamp {
+        quint64 inode = 0;
+        qint64 size = 0;
+        qint64 mtimeNs = 0;
+
+        bool operator==(const FileStamp& other) const {
+            return inode == other.inode && size == other.size && mtimeNs == other.mtimeNs;
+        }
+        bool operator!=(const FileStamp& other) const { return !(*this == other); }
+    };
+
+    struct DirectoryState {
+        // -1 until the directory has been listed
+        qint64 mtimeNs = -1;
+        QHash<QString, FileStamp> files;
+        QStringList subdirectories;
+    };
+
+    struct FileChange {
+        QString name;
+        FileStamp stamp;
+    };
+
+    // Result of checking one directory; computed in parallel, applied in order
+    struct DirectoryDelta {
+        QString path;
+        bool gone = false;
+        bool listed = false;
+        qint64 mtimeNs = -1;
+        int filesChecked = 0;
+        QVector<FileChange> created;
+        QVector<FileChange> changed;
+        QStringList deleted;
+        QStringList subdirectories;
+    };
+
+    struct PathChange {
+        QString path;
+        FileStamp stamp;
+    };
+
+    DirectoryDelta checkDirectory(const QString& path, const std::atomic<bool>* cancelled) const;
+    void listDirectory(const DirectoryState* state, DirectoryDelta* delta) const;
+    void removeTree(const QString& path, QVector<PathChange>* deleted);
+
+    QString m_root;
+    ExclusionMatcher m_exclusions;
+    // Keyed by absolute directory path
+    QHash<QString, DirectoryState> m_directories;
+    int m_fileCount = 0;
+    // False until seeded or the first scan has built the index
+    bool m_seeded = false;
+    ScanStats m_lastScan;
+};
+
+#endif // POLLING_SCANNER_H
@@ -0,0 +1,1094 @@
+#include "watcher_service.h"
+#include <QFileInfo>
+#include <QDirIterator>
+#include <QDir>
+#include <QFile>
+#include <QCoreApplication>
+#include <QThread>
+#include <QTimer>
+#include <QFutureWatcher>
+#include <QtConcurrent/QtConcurrent>
+#include <algorithm>
+
+#ifdef Q_OS_LINUX
+#include "inotify_watcher.h"
+#include "fanotify_watcher.h"
+#endif
+
+WatcherService::WatcherService(QObject* parent)
+    : QThread(parent),
+      m_watcher(nullptr),
+      m_inotify(nullptr),
+      m_fanotify(nullptr),
+      m_running(false),
+      m_debounceTimer(nullptr),
+      m_debounceMs(WatcherConfig::DUPLICATE_EVENT_THRESHOLD_MS),
+      m_flushTimer(nullptr),
+      m_coalesceWindowMs(WatcherConfig::DEFAULT_COALESCE_WINDOW_MS),
+      m_scanTimer(nullptr),
+      m_pollTimer(nullptr),
+      m_pollIntervalMs(PollingConfig::DEFAULT_INTERVAL_MS),
+      m_pollCancelled(false)
+{
+    m_pollPool.setMaxThreadCount(PollingConfig::MAX_PARALLEL_DIRECTORIES);
+}
+
+WatcherService::~WatcherService()
+{
+    stop();
+}
+
+void WatcherService::addRoot(const Root& root)
+{
+    RootState state;
+    state.config = root;
+    state.config.path = QDir::cleanPath(root.path);
+    if (state.config.mode == WatchMode::Native) {
+        m_rootsByPath[state.config.path].append(int(m_roots.size()));
+    } else if (state.config.mode == WatchMode::Mount) {
+        m_mountRootsByPath[state.config.path].append(int(m_roots.size()));
+    }
+    m_roots.push_back(std::move(state));
+}
+
+bool WatcherService::hasSystem(int systemIndex) const
+{
+    for (const RootState& root : m_roots) {
+        if (root.config.systemIndex == systemIndex) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool WatcherService::isStopping() const
+{
+    QMutexLocker locker(&m_mutex);
+    return !m_running;
+}
+
+QVector<int> WatcherService::rootsContaining(const QString& path, WatchMode source) const
+{
+    const QHash<QString, QVector<int>>& rootsByPath =
+        source == WatchMode::Mount ? m_mountRootsByPath : m_rootsByPath;
+    QVector<int> roots;
+    QString candidate = path;
+    for (;;) {
+        const auto it = rootsByPath.constFind(candidate);
+        if (it != rootsByPath.constEnd()) {
+            roots += it.value();
+        }
+
+        const int slash = candidate.lastIndexOf(QLatin1Char('/'));
+        if (slash < 0) {
+            break;
+        }
+        // Filesystem and drive roots keep their trailing slash once cleaned
+        if (slash == 0 || (slash == 2 && candidate.at(1) == QLatin1Char(':'))) {
+            if (candidate.size() > slash + 1) {
+                const auto rootIt = rootsByPath.constFind(candidate.left(slash + 1));
+                if (rootIt != rootsByPath.constEnd()) {
+                    roots += rootIt.value();
+                }
+            }
+            break;
+        }
+        candidate.truncate(slash);
+    }
+    return roots;
+}
+
+QVector<int> WatcherService::rootsIncluding(const QString& path, WatchMode source) const
+{
+    QVector<int> roots = rootsContaining(path, source);
+    roots.erase(std::remove_if(roots.begin(), roots.end(), [this, &path](int root) {
+        return m_roots[size_t(root)].config.exclusions.isExcluded(path);
+    }), roots.end());
+    return roots;
+}
+
+void WatcherService::demoteToNative(int rootIndex)
+{
+    Root& config = m_roots[size_t(rootIndex)].config;
+    QVector<int>& mountRoots = m_mountRootsByPath[config.path];
+    mountRoots.removeAll(rootIndex);
+    if (mountRoots.isEmpty()) {
+        m_mountRootsByPath.remove(config.path);
+    }
+    config.mode = WatchMode::Native;
+    m_rootsByPath[config.path].append(rootIndex);
+}
+
+bool WatcherService::addWatchPath(const QString& path, bool isDir)
+{
+    if (!m_watcher) {
+        return false;
+    }
+
+    QSet<QString>& registry = isDir ? m_watchedDirectories : m_watchedFiles;
+    if (registry.contains(path)) {
+        return false;
+    }
+
+    if (!m_watcher->addPath(path)) {
+        return false;
+    }
+
+    registry.insert(path);
+    updateWatchedPathCount();
+    return true;
+}
+
+void WatcherService::removeWatchPath(const QString& path)
+{
+    const bool wasFile = m_watchedFiles.remove(path);
+    const bool wasDir = m_watchedDirectories.remove(path);
+    if (!wasFile && !wasDir) {
+        return;
+    }
+
+    if (m_watcher) {
+        m_watcher->removePath(path);
+    }
+    updateWatchedPathCount();
+}
+
+void WatcherService::updateWatchedPathCount()
+{
+    int count = m_watchedFiles.size() + m_watchedDirectories.size();
+#ifdef Q_OS_LINUX
+    if (m_inotify) {
+        count += m_inotify->watchCount();
+    }
+#endif
+    m_watchedPathCount.storeRelaxed(count);
+}
+
+void WatcherService::run()
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        m_running = true;
+    }
+
+    // Signal that baseline should be captured now
+    emit preloadComplete();
+
+    // Timers are created here so they belong to this thread's event loop
+    m_clock.start();
+    for (RootState& root : m_roots) {
+        root.debounce.setQuietPeriod(m_debounceMs);
+    }
+    m_debounceTimer = new QTimer();
+    m_debounceTimer->setInterval(int(DebounceWheel(m_debounceMs).tickInterval()));
+    connect(m_debounceTimer, &QTimer::timeout, m_debounceTimer, [this]() {
+        releaseSettledEvents();
+    });
+
+    m_flushTimer = new QTimer();
+    m_flushTimer->setSingleShot(true);
+    m_flushTimer->setInterval(m_coalesceWindowMs);
+    connect(m_flushTimer, &QTimer::timeout, m_flushTimer, [this]() {
+        flushEvents();
+    });
+
+    // Zero interval: one slice per event loop pass while scans are queued
+    m_scanTimer = new QTimer();
+    m_scanTimer->setInterval(0);
+    connect(m_scanTimer, &QTimer::timeout, m_scanTimer, [this]() {
+        processPendingScans();
+    });
+
+    // Polled roots take no kernel watches
+    startPolling();
+
+    // Whole-mount roots the fanotify backend cannot take go native
+    if (!m_mountRootsByPath.isEmpty()) {
+        bool mountBackend = false;
+#ifdef Q_OS_LINUX
+        mountBackend = startMountBackend();
+#endif
+        if (!mountBackend) {
+            for (int i = 0; i < rootCount(); ++i) {
+                if (m_roots[size_t(i)].config.mode == WatchMode::Mount) {
+                    demoteToNative(i);
+                }
+            }
+        }
+    }
+
+    bool nativeBackend = m_rootsByPath.isEmpty();
+#ifdef Q_OS_LINUX
+    if (!nativeBackend) {
+        nativeBackend = startNativeBackend();
+    }
+#endif
+
+    if (!nativeBackend) {
+        // Create file system watcher in this thread
+        m_watcher = new QFileSystemWatcher();
+
+        // Watch every root and all subdirectories; shared paths are
+        // registered once
+        for (int i = 0; i < rootCount() && !isStopping(); ++i) {
+            if (m_roots[size_t(i)].config.mode == WatchMode::Native) {
+                addWatchRecursively(i);
+            }
+        }
+
+        // Connect file change signal (handled on this thread, the watch
+        // registry is only ever touched from here)
+        connect(m_watcher, &QFileSystemWatcher::fileChanged, this,
+                [this](const QString& path) {
+            handleFileChanged(path);
+        }, Qt::DirectConnection);
+
+        // Connect directory change signal
+        connect(m_watcher, &QFileSystemWatcher::directoryChanged, this,
+                [this](const QString& path) {
+            handleDirectoryChanged(path);
+        }, Qt::DirectConnection);
+    }
+
+    emit startedWatching();
+
+    // Use Qt's event loop
+    exec();
+
+    stopPolling();
+    delete m_scanTimer;
+    m_scanTimer = nullptr;
+    m_pendingScans.clear();
+    m_pendingScanPaths.clear();
+
+    // Deliver what was still settling or waiting for its window to close
+    for (RootState& root : m_roots) {
+        for (const FileEvent& event : root.debounce.takeAll()) {
+            root.coalescer.add(event.path, event.kind);
+        }
+    }
+    flushEvents();
+    delete m_debounceTimer;
+    m_debounceTimer = nullptr;
+    delete m_flushTimer;
+    m_flushTimer = nullptr;
+
+    // Clean up after event loop exits
+    if (m_watcher) {
+        m_watcher->disconnect();
+        delete m_watcher;
+        m_watcher = nullptr;
+    }
+    m_watchedFiles.clear();
+    m_watchedDirectories.clear();
+#ifdef Q_OS_LINUX
+    delete m_inotify;
+    m_inotify = nullptr;
+    delete m_fanotify;
+    m_fanotify = nullptr;
+#endif
+    m_watchedPathCount.storeRelaxed(0);
+
+    emit stoppedWatching();
+}
+
+void WatcherService::handleFileChanged(const QString& path)
+{
+    const QVector<int> roots = rootsIncluding(path);
+    if (roots.isEmpty()) {
+        return;
+    }
+
+    QFileInfo info(path);
+    if (!info.exists()) {
+        // QFileSystemWatcher has already dropped its watch for a removed file
+        m_watchedFiles.remove(path);
+        updateWatchedPathCount();
+        for (int root : roots) {
+            queueEvent(root, path, FileEvent::Kind::Deleted);
+        }
+        return;
+    }
+
+    // Re-add watch (QFileSystemWatcher removes it after change on some systems,
+    // e.g. when an editor replaces the file), so always point it at the current file
+    if (m_watcher) {
+        removeWatchPath(path);
+        addWatchPath(path, false);
+    }
+
+    for (int root : roots) {
+        queueEvent(root, path, FileEvent::Kind::Changed);
+    }
+}
+
+void WatcherService::handleDirectoryChanged(const QString& path)
+{
+    const QVector<int> roots = rootsIncluding(path);
+    if (roots.isEmpty()) {
+        return;
+    }
+
+    if (!QFileInfo(path).isDir()) {
+        // Directory is gone; QFileSystemWatcher already dropped it
+        m_watchedDirectories.remove(path);
+        updateWatchedPathCount();
+        return;
+    }
+
+    // Re-add watch for the directory itself
+    addWatchPath(path, true);
+
+    // Listed on the next slice, so a burst of changes lists it once
+    enqueueScan(path, roots, WatchMode::Native, false);
+}
+
+void WatcherService::enqueueScan(const QString& path, const QVector<int>& roots,
+                                 WatchMode source, bool newTree)
+{
+    if (m_pendingScanPaths.contains(path)) {
+        return;
+    }
+
+    PendingScan scan;
+    scan.path = path;
+    scan.roots = roots;
+    scan.source = source;
+    scan.newTree = newTree;
+    m_pendingScans.enqueue(scan);
+    m_pendingScanPaths.insert(path);
+
+    if (m_scanTimer && !m_scanTimer->isActive()) {
+        m_scanTimer->start();
+    }
+}
+
+void WatcherService::processPendingScans()
+{
+    QElapsedTimer slice;
+    slice.start();
+    while (!m_pendingScans.isEmpty() && !isStopping()) {
+        const PendingScan scan = m_pendingScans.dequeue();
+        m_pendingScanPaths.remove(scan.path);
+        scanDirectory(scan);
+
+        if (slice.elapsed() >= WatcherConfig::SCAN_SLICE_MS) {
+            break;
+        }
+    }
+
+    updateWatchedPathCount();
+    if (m_pendingScans.isEmpty()) {
+        m_scanTimer->stop();
+    }
+}
+
+bool WatcherService::isWatchedDirectory(const QString& path) const
+{
+#ifdef Q_OS_LINUX
+    if (m_inotify && m_inotify->isWatching(path)) {
+        return true;
+    }
+#endif
+    return m_watchedDirectories.contains(path);
+}
+
+void WatcherService::scanDirectory(const PendingScan& scan)
+{
+    // Watch first, then list: a file created after the listing raises an
+    // event of its own, one created before is found by the listing
+    if (scan.source == WatchMode::Native) {
+        bool watched = false;
+#ifdef Q_OS_LINUX
+        if (m_inotify) {
+            m_inotify->addDirectory(scan.path);
+            watched = true;
+        }
+#endif
+        if (!watched) {
+            addWatchPath(scan.path, true);
+        }
+    }
+
+    // One level per scan; subdirectories are queued behind it
+    QDirIterator it(scan.path, QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot | QDir::NoSymLinks);
+    QVector<int> including;
+    while (it.hasNext()) {
+        const QString entryPath = it.next();
+        const bool isDir = it.fileInfo().isDir();
+
+        // Cheap registry lookup first, exclusion rules only for unknown paths
+        if (!scan.newTree) {
+            if (isDir ? isWatchedDirectory(entryPath) : m_watchedFiles.contains(entryPath)) {
+                continue;
+            }
+        }
+
+        including.clear();
+        for (int root : scan.roots) {
+            const ExclusionMatcher& exclusions = m_roots[size_t(root)].config.exclusions;
+            if (!(isDir ? exclusions.isDirectoryExcluded(entryPath) : exclusions.isExcluded(entryPath))) {
+                including.append(root);
+            }
+        }
+        if (including.isEmpty()) {
+            continue;
+        }
+
+        if (isDir) {
+            if (!scan.newTree) {
+                for (int root : including) {
+                    emit logMessage(m_roots[size_t(root)].config.systemIndex,
+                                    QString("New directory detected: %1").arg(entryPath));
+                }
+            }
+            enqueueScan(entryPath, including, scan.source, true);
+            continue;
+        }
+
+        if (m_watcher && scan.source == WatchMode::Native) {
+            addWatchPath(entryPath, false);
+        }
+        for (int root : including) {
+            queueEvent(root, entryPath, FileEvent::Kind::Created);
+        }
+    }
+}
+
+void WatcherService::queueEvent(const QString& path, FileEvent::Kind kind, WatchMode source)
+{
+    for (int root : rootsIncluding(path, source)) {
+        queueEvent(root, path, kind);
+    }
+}
+
+void WatcherService::queueEvent(int rootIndex, const QString& path, FileEvent::Kind kind)
+{
+    RootState& root = m_roots[size_t(rootIndex)];
+    const bool bypass = m_debounceMs <= 0 || !m_debounceTimer ||
+        (root.debounce.size() >= WatcherConfig::MAX_DEBOUNCED_PATHS && !root.debounce.contains(path));
+    if (bypass) {
+        addToBatch(rootIndex, path, kind);
+        return;
+    }
+
+    root.debounce.schedule(path, kind, m_clock.elapsed());
+    if (!m_debounceTimer->isActive()) {
+        m_debounceTimer->start();
+    }
+}
+
+void WatcherService::queueRename(int rootIndex, const QString& oldPath, const QString& newPath, bool isDirectory)
+{
+    // Renames are reported without delay; events still settling for the old
+    // path follow the file to its new one
+    RootState& root = m_roots[size_t(rootIndex)];
+    if (m_debounceTimer) {
+        root.debounce.rename(oldPath, newPath, isDirectory, m_clock.elapsed());
+    }
+    root.coalescer.addRename(oldPath, newPath, isDirectory);
+    scheduleFlush(rootIndex);
+}
+
+void WatcherService::queueDirectoryRemoval(int rootIndex, const QString& path)
+{
+    // Like renames, reported without delay; nothing below it is left to settle
+    RootState& root = m_roots[size_t(rootIndex)];
+    root.debounce.removeDirectory(path);
+    root.coalescer.addDirectoryRemoval(path);
+    scheduleFlush(rootIndex);
+}
+
+void WatcherService::queueDirectoryRemoval(const QString& path, WatchMode source)
+{
+    for (int root : rootsIncluding(path, source)) {
+        queueDirectoryRemoval(root, path);
+    }
+}
+
+void WatcherService::releaseSettledEvents()
+{
+    const qint64 now = m_clock.elapsed();
+    bool pending = false;
+    for (int i = 0; i < rootCount(); ++i) {
+        DebounceWheel& debounce = m_roots[size_t(i)].debounce;
+        if (debounce.isEmpty()) {
+            continue;
+        }
+        for (const FileEvent& event : debounce.advance(now)) {
+            addToBatch(i, event.path, event.kind);
+        }
+        pending = pending || !debounce.isEmpty();
+    }
+    if (!pending) {
+        m_debounceTimer->stop();
+    }
+}
+
+void WatcherService::addToBatch(int rootIndex, const QString& path, FileEvent::Kind kind)
+{
+    m_roots[size_t(rootIndex)].coalescer.add(path, kind);
+    scheduleFlush(rootIndex);
+}
+
+void WatcherService::scheduleFlush(int rootIndex)
+{
+    if (m_roots[size_t(rootIndex)].coalescer.size() >= WatcherConfig::MAX_BATCH_EVENTS) {
+        flushRoot(rootIndex);
+    } else if (m_flushTimer && !m_flushTimer->isActive()) {
+        // Not restarted by later events, so a steady stream still flushes
+        m_flushTimer->start();
+    }
+}
+
+void WatcherService::flushEvents()
+{
+    if (m_flushTimer) {
+        m_flushTimer->stop();
+    }
+    for (int i = 0; i < rootCount(); ++i) {
+        flushRoot(i);
+    }
+}
+
+void WatcherService::flushRoot(int rootIndex)
+{
+    RootState& root = m_roots[size_t(rootIndex)];
+    if (root.coalescer.isEmpty()) {
+        return;
+    }
+
+    const int merged = root.coalescer.mergedCount();
+    const FileEventBatch events = root.coalescer.take();
+    if (events.isEmpty()) {
+        return;
+    }
+
+    int changed = 0;
+    int created = 0;
+    int deleted = 0;
+    int renamed = 0;
+    for (const FileEvent& event : events) {
+        switch (event.kind) {
+            case FileEvent::Kind::Changed:
+                ++changed;
+                break;
+            case FileEvent::Kind::Created:
+                ++created;
+                break;
+            case FileEvent::Kind::Deleted:
+                ++deleted;
+                break;
+            case FileEvent::Kind::Renamed:
+                ++renamed;
+                break;
+        }
+    }
+
+    const int systemIndex = root.config.systemIndex;
+    emit fileEvents(systemIndex, events);
+    if (events.size() == 1) {
+        const FileEvent& event = events.first();
+        emit logMessage(systemIndex, event.kind == FileEvent::Kind::Renamed
+            ? QString("Rename detected: %1 -> %2").arg(event.oldPath).arg(event.path)
+            : QString("Change detected: %1").arg(event.path));
+    } else {
+        emit logMessage(systemIndex, QString("Changes detected: %1 modified, %2 created, %3 deleted, %4 renamed (%5 repeated events merged)")
+            .arg(changed).arg(created).arg(deleted).arg(renamed).arg(merged));
+    }
+}
+
+bool WatcherService::startPolling()
+{
+    bool anyPolled = false;
+    for (int i = 0; i < rootCount(); ++i) {
+        RootState& root = m_roots[size_t(i)];
+        if (root.config.mode != WatchMode::Polling) {
+            continue;
+        }
+        anyPolled = true;
+
+        root.poller = std::make_unique<PollingScanner>(root.config.path, root.config.exclusions);
+        if (root.config.manifest) {
+            root.poller->seed(*root.config.manifest);
+            root.config.manifest.reset();
+        }
+
+        root.pollWatcher = new QFutureWatcher<FileEventBatch>();
+        connect(root.pollWatcher, &QFutureWatcher<FileEventBatch>::finished, root.pollWatcher, [this, i]() {
+            finishPoll(i);
+        });
+
+        emit logMessage(root.config.systemIndex, QString("Polling %1 file(s) in %2 every %3 ms")
+            .arg(root.poller->fileCount()).arg(root.config.systemName).arg(m_pollIntervalMs));
+    }
+
+    if (!anyPolled) {
+        return false;
+    }
+
+    m_pollCancelled = false;
+    m_pollTimer = new QTimer();
+    m_pollTimer->setInterval(m_pollIntervalMs);
+    connect(m_pollTimer, &QTimer::timeout, m_pollTimer, [this]() {
+        pollRoots();
+    });
+    m_pollTimer->start();
+    pollRoots();
+    return true;
+}
+
+void WatcherService::pollRoots()
+{
+    for (RootState& root : m_roots) {
+        // A scan still running when the next is due is not started twice
+        if (!root.poller || root.pollWatcher->isRunning()) {
+            continue;
+        }
+
+        PollingScanner* scanner = root.poller.get();
+        root.pollWatcher->setFuture(QtConcurrent::run([this, scanner]() {
+            return scanner->scan(&m_pollPool, &m_pollCancelled);
+        }));
+    }
+}
+
+void WatcherService::finishPoll(int rootIndex)
+{
+    if (m_pollCancelled) {
+        return;
+    }
+
+    RootState& root = m_roots[size_t(rootIndex)];
+    const FileEventBatch events = root.pollWatcher->result();
+    const PollingScanner::ScanStats& scan = root.poller->lastScan();
+    ++root.pollScans;
+    root.pollTotalMs += scan.durationMs;
+    root.pollMaxMs = qMax(root.pollMaxMs, scan.durationMs);
+
+    const int systemIndex = root.config.systemIndex;
+    if (root.pollScans == 1 || scan.durationMs > m_pollIntervalMs) {
+        emit logMessage(systemIndex, QString("%1 scan took %2 ms%3: %4 director(ies) checked, %5 listed, %6 file(s) checked")
+            .arg(root.pollScans == 1 ? "First poll" : "Poll")
+            .arg(scan.durationMs)
+            .arg(scan.durationMs > m_pollIntervalMs
+                 ? QString(", longer than the %1 ms interval").arg(m_pollIntervalMs) : QString())
+            .arg(scan.directoriesChecked)
+            .arg(scan.directoriesListed)
+            .arg(scan.filesChecked));
+    }
+
+    for (const FileEvent& event : events) {
+        if (event.kind == FileEvent::Kind::Renamed) {
+            queueRename(rootIndex, event.oldPath, event.path, event.isDirectory);
+        } else {
+            queueEvent(rootIndex, event.path, event.kind);
+        }
+    }
+}
+
+void WatcherService::stopPolling()
+{
+    // Scans in flight give up between directories
+    m_pollCancelled = true;
+    delete m_pollTimer;
+    m_pollTimer = nullptr;
+
+    for (RootState& root : m_roots) {
+        if (!root.pollWatcher) {
+            continue;
+        }
+        root.pollWatcher->waitForFinished();
+        delete root.pollWatcher;
+        root.pollWatcher = nullptr;
+
+        if (root.pollScans > 0) {
+            emit logMessage(root.config.systemIndex, QString("Polling: %1 scan(s), average %2 ms, max %3 ms over %4 director(ies) and %5 file(s)")
+                .arg(root.pollScans)
+                .arg(root.pollTotalMs / root.pollScans)
+                .arg(root.pollMaxMs)
+                .arg(root.poller->directoryCount())
+                .arg(root.poller->fileCount()));
+        }
+        root.poller.reset();
+    }
+    m_pollPool.waitForDone();
+}
+
+void WatcherService::stop()
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        if (!m_running) {
+            return;
+        }
+        m_running = false;
+    }
+
+    // Request thread to exit event loop
+    quit();
+
+    // Wait for thread to finish with timeout
+    if (!wait(5000)) {
+        emit logMessage(-1, "Warning: Watcher thread forced to terminate");
+        terminate();
+        wait();
+    }
+}
+
+void WatcherService::addWatchRecursively(int rootIndex)
+{
+    RootState& root = m_roots[size_t(rootIndex)];
+    const int systemIndex = root.config.systemIndex;
+    const QString& path = root.config.path;
+    emit logMessage(systemIndex, QString("Setting up file monitoring for %1").arg(root.config.systemName));
+
+    addWatchPath(path, true);
+
+    if (root.config.manifest) {
+        // The startup scan already knows every directory and file
+        const std::shared_ptr<const FileManifest> manifest = std::move(root.config.manifest);
+        for (const QString& dir : manifest->directories()) {
+            addWatchPath(manifest->absolutePath(dir), true);
+        }
+        for (const ManifestEntry& file : manifest->files()) {
+            if (isStopping()) {
+                emit logMessage(systemIndex, QString("Stopped monitoring setup for %1").arg(root.config.systemName));
+                return;
+            }
+            addWatchPath(manifest->absolutePath(file.relativePath), false);
+        }
+        emit logMessage(systemIndex, QString("Monitoring %1 file(s) in %2 (%3 watched paths across all systems)")
+            .arg(manifest->fileCount()).arg(root.config.systemName).arg(watchedPathCount()));
+        return;
+    }
+
+    QDirIterator it(path, QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot,
+                    QDirIterator::Subdirectories);
+    qint64 fileCount = 0;
+
+    while (it.hasNext()) {
+        if (isStopping()) {
+            emit logMessage(systemIndex, QString("Stopped monitoring setup for %1").arg(root.config.systemName));
+            return;
+        }
+
+        QString filePath = it.next();
+
+        if (root.config.exclusions.isExcluded(filePath)) {
+            continue;
+        }
+
+        // Reuse the iterator's cached file info instead of stat'ing again
+        const bool isDir = it.fileInfo().isDir();
+        addWatchPath(filePath, isDir);
+
+        if (!isDir) {
+            ++fileCount;
+        }
+    }
+
+    emit logMessage(systemIndex, QString("Monitoring %1 file(s) in %2 (%3 watched paths across all systems)")
+        .arg(fileCount).arg(root.config.systemName).arg(watchedPathCount()));
+}
+
+#ifdef Q_OS_LINUX
+bool WatcherService::startNativeBackend()
+{
+    m_inotify = new InotifyWatcher();
+    if (!m_inotify->isValid()) {
+        emit logMessage(-1, "inotify unavailable, falling back to QFileSystemWatcher");
+        delete m_inotify;
+        m_inotify = nullptr;
+        return false;
+    }
+
+    // Handlers run on this thread, where the inotify descriptor is read
+    connect(m_inotify, &InotifyWatcher::fileModified, m_inotify,
+            [this](const QString& path) {
+        queueEvent(path, FileEvent::Kind::Changed);
+    });
+    connect(m_inotify, &InotifyWatcher::fileCreated, m_inotify,
+            [this](const QString& path) {
+        queueEvent(path, FileEvent::Kind::Created);
+    });
+    connect(m_inotify, &InotifyWatcher::fileDeleted, m_inotify,
+            [this](const QString& path) {
+        queueEvent(path, FileEvent::Kind::Deleted);
+    });
+    connect(m_inotify, &InotifyWatcher::directoryCreated, m_inotify,
+            [this](const QString& path) {
+        handleNativeDirectoryCreated(path);
+    });
+    connect(m_inotify, &InotifyWatcher::directoryDeleted, m_inotify,
+            [this](const QString& path) {
+        // Also raised for a directory moved out of the watched tree, whose
+        // files got no events of their own
+        queueDirectoryRemoval(path, WatchMode::Native);
+        updateWatchedPathCount();
+    });
+    connect(m_inotify, &InotifyWatcher::fileRenamed, m_inotify,
+            [this](const QString& oldPath, const QString& newPath) {
+        handleFileRenamed(oldPath, newPath, WatchMode::Native);
+    });
+    connect(m_inotify, &InotifyWatcher::directoryRenamed, m_inotify,
+            [this](const QString& oldPath, const QString& newPath) {
+        handleNativeDirectoryRenamed(oldPath, newPath);
+    });
+    connect(m_inotify, &InotifyWatcher::eventQueueOverflow, m_inotify, [this]() {
+        emit logMessage(-1, "Warning: inotify event queue overflowed, some changes may have been missed");
+    });
+
+    for (int i = 0; i < rootCount() && !isStopping(); ++i) {
+        RootState& root = m_roots[size_t(i)];
+        if (root.config.mode != WatchMode::Native) {
+            continue;
+        }
+        const int systemIndex = root.config.systemIndex;
+        emit logMessage(systemIndex, QString("Setting up file monitoring for %1").arg(root.config.systemName));
+
+        // Directories already watched for an overlapping root are shared
+        const int before = m_inotify->watchCount();
+        int dirCount = 1;
+        if (root.config.manifest) {
+            // The startup scan already knows every directory, no second walk
+            const std::shared_ptr<const FileManifest> manifest = std::move(root.config.manifest);
+            m_inotify->addDirectory(root.config.path);
+            for (const QString& dir : manifest->directories()) {
+                m_inotify->addDirectory(manifest->absolutePath(dir));
+            }
+            dirCount += manifest->directories().size();
+        } else {
+            dirCount = addDirectoryWatchesRecursively(root.config.path, {i});
+        }
+        const int added = m_inotify->watchCount() - before;
+        emit logMessage(systemIndex, QString("Monitoring %1 director(ies) in %2 (inotify, %3 shared with other systems)")
+            .arg(dirCount).arg(root.config.systemName).arg(qMax(0, dirCount - added)));
+    }
+    updateWatchedPathCount();
+    return true;
+}
+
+int WatcherService::addDirectoryWatchesRecursively(const QString& path, const QVector<int>& roots)
+{
+    m_inotify->addDirectory(path);
+    int dirCount = 1;
+
+    // Only directories need a watch; files are reported through their parent
+    QDirIterator it(path, QDir::Dirs | QDir::NoDotAndDotDot | QDir::NoSymLinks,
+                    QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        if (isStopping()) {
+            return dirCount;
+        }
+
+        const QString entryPath = it.next();
+        for (int root : roots) {
+            if (!m_roots[size_t(root)].config.exclusions.isExcluded(entryPath)) {
+                m_inotify->addDirectory(entryPath);
+                ++dirCount;
+                break;
+            }
+        }
+    }
+
+    return dirCount;
+}
+
+void WatcherService::handleNativeDirectoryCreated(const QString& path)
+{
+    const QVector<int> roots = rootsIncluding(path);
+    if (roots.isEmpty()) {
+        return;
+    }
+
+    for (int root : roots) {
+        emit logMessage(m_roots[size_t(root)].config.systemIndex,
+                        QString("New directory detected: %1").arg(path));
+    }
+    enqueueScan(path, roots, WatchMode::Native, true);
+}
+
+void WatcherService::handleFileRenamed(const QString& oldPath, const QString& newPath, WatchMode source)
+{
+    // Moving across a root or exclusion boundary only shows up on one side
+    const QVector<int> fromRoots = rootsIncluding(oldPath, source);
+    const QVector<int> toRoots = rootsIncluding(newPath, source);
+    for (int root : fromRoots) {
+        if (toRoots.contains(root)) {
+            queueRename(root, oldPath, newPath, false);
+        } else {
+            queueEvent(root, oldPath, FileEvent::Kind::Deleted);
+        }
+    }
+    for (int root : toRoots) {
+        if (!fromRoots.contains(root)) {
+            queueEvent(root, newPath, FileEvent::Kind::Created);
+        }
+    }
+}
+
+void WatcherService::handleNativeDirectoryRenamed(const QString& oldPath, const QString& newPath)
+{
+    const QVector<int> fromRoots = rootsIncluding(oldPath);
+    const QVector<int> toRoots = rootsIncluding(newPath);
+    if (toRoots.isEmpty()) {
+        // Its watches moved along with it; trees no root includes are not watched
+        m_inotify->removeDirectory(newPath);
+        updateWatchedPathCount();
+    }
+
+    for (int root : fromRoots) {
+        const int systemIndex = m_roots[size_t(root)].config.systemIndex;
+        if (toRoots.contains(root)) {
+            queueRename(root, oldPath, newPath, true);
+            emit logMessage(systemIndex, QString("Directory renamed: %1 -> %2").arg(oldPath).arg(newPath));
+        } else {
+            queueDirectoryRemoval(root, oldPath);
+            emit logMessage(systemIndex, QString("Directory moved out of scope: %1").arg(oldPath));
+        }
+    }
+
+    QVector<int> entering;
+    for (int root : toRoots) {
+        if (!fromRoots.contains(root)) {
+            entering.append(root);
+        }
+    }
+    if (!entering.isEmpty()) {
+        // Its subdirectories kept their watches, but their files are new
+        // to these roots
+        for (int root : entering) {
+            emit logMessage(m_roots[size_t(root)].config.systemIndex,
+                            QString("New directory detected: %1").arg(newPath));
+        }
+        enqueueScan(newPath, entering, WatchMode::Native, true);
+    }
+}
+
+bool WatcherService::startMountBackend()
+{
+    m_fanotify = new FanotifyWatcher();
+    if (!m_fanotify->isValid()) {
+        emit logMessage(-1, QString("fanotify unavailable (%1), watching whole-mount systems with inotify")
+            .arg(m_fanotify->errorString()));
+        delete m_fanotify;
+        m_fanotify = nullptr;
+        return false;
+    }
+
+    bool anyMarked = false;
+    for (int i = 0; i < rootCount(); ++i) {
+        RootState& root = m_roots[size_t(i)];
+        if (root.config.mode != WatchMode::Mount) {
+            continue;
+        }
+
+        // Several roots on one file system share its mark
+        if (!m_fanotify->addFilesystem(root.config.path)) {
+            emit logMessage(root.config.systemIndex, QString("Cannot watch the mount of %1 with fanotify (%2), using inotify")
+                .arg(root.config.systemName).arg(m_fanotify->errorString()));
+            demoteToNative(i);
+            continue;
+        }
+
+        anyMarked = true;
+        root.config.manifest.reset();
+        emit logMessage(root.config.systemIndex, QString("Monitoring %1 through one fanotify mark on its file system")
+            .arg(root.config.systemName));
+    }
+
+    if (!anyMarked) {
+        delete m_fanotify;
+        m_fanotify = nullptr;
+        return false;
+    }
+
+    // Events cover whole file systems; routing keeps those below mount roots
+    connect(m_fanotify, &FanotifyWatcher::fileModified, m_fanotify,
+            [this](const QString& path) {
+        queueEvent(path, FileEvent::Kind::Changed, WatchMode::Mount);
+    });
+    connect(m_fanotify, &FanotifyWatcher::fileCreated, m_fanotify,
+            [this](const QString& path) {
+        queueEvent(path, FileEvent::Kind::Created, WatchMode::Mount);
+    });
+    connect(m_fanotify, &FanotifyWatcher::fileDeleted, m_fanotify,
+            [this](const QString& path) {
+        queueEvent(path, FileEvent::Kind::Deleted, WatchMode::Mount);
+    });
+    connect(m_fanotify, &FanotifyWatcher::directoryCreated, m_fanotify,
+            [this](const QString& path) {
+        // Nothing to register, the mark already covers it
+        for (int root : rootsIncluding(path, WatchMode::Mount)) {
+            emit logMessage(m_roots[size_t(root)].config.systemIndex,
+                            QString("New directory detected: %1").arg(path));
+        }
+    });
+    connect(m_fanotify, &FanotifyWatcher::directoryMovedIn, m_fanotify,
+            [this](const QString& path) {
+        const QVector<int> roots = rootsIncluding(path, WatchMode::Mount);
+        if (!roots.isEmpty()) {
+            reportFilesBelow(path, roots);
+        }
+    });
+    connect(m_fanotify, &FanotifyWatcher::directoryDeleted, m_fanotify,
+            [this](const QString& path) {
+        // Without FAN_RENAME also raised for a directory moved away, whose
+        // files got no events of their own
+        queueDirectoryRemoval(path, WatchMode::Mount);
+    });
+    connect(m_fanotify, &FanotifyWatcher::fileRenamed, m_fanotify,
+            [this](const QString& oldPath, const QString& newPath) {
+        handleFileRenamed(oldPath, newPath, WatchMode::Mount);
+    });
+    connect(m_fanotify, &FanotifyWatcher::directoryRenamed, m_fanotify,
+            [this](const QString& oldPath, const QString& newPath) {
+        handleMountDirectoryRenamed(oldPath, newPath);
+    });
+    connect(m_fanotify, &FanotifyWatcher::eventQueueOverflow, m_fanotify, [this]() {
+        emit logMessage(-1, "Warning: fanotify event queue overflowed, some changes may have been missed");
+    });
+
+    emit logMessage(-1, QString("fanotify watching %1 file system(s)%2")
+        .arg(m_fanotify->filesystemCount())
+        .arg(m_fanotify->reportsRenames() ? QString() : QString(", moves reported as delete and create")));
+    return true;
+}
+
+void WatcherService::handleMountDirectoryRenamed(const QString& oldPath, const QString& newPath)
+{
+    const QVector<int> fromRoots = rootsIncluding(oldPath, WatchMode::Mount);
+    const QVector<int> toRoots = rootsIncluding(newPath, WatchMode::Mount);
+
+    for (int root : fromRoots) {
+        const int systemIndex = m_roots[size_t(root)].config.systemIndex;
+        if (toRoots.contains(root)) {
+            queueRename(root, oldPath, newPath, true);
+            emit logMessage(systemIndex, QString("Directory renamed: %1 -> %2").arg(oldPath).arg(newPath));
+        } else {
+            queueDirectoryRemoval(root, oldPath);
+            emit logMessage(systemIndex, QString("Directory moved out of scope: %1").arg(oldPath));
+        }
+    }
+
+    QVector<int> entering;
+    for (int root : toRoots) {
+        if (!fromRoots.contains(root)) {
+            entering.append(root);
+        }
+    }
+    if (!entering.isEmpty()) {
+        reportFilesBelow(newPath, entering);
+    }
+}
+
+void WatcherService::reportFilesBelow(const QString& path, const QVector<int>& roots)
+{
+    for (int root : roots) {
+        emit logMessage(m_roots[size_t(root)].config.systemIndex,
+                        QString("New directory detected: %1").arg(path));
+    }
+    enqueueScan(path, roots, WatchMode::Mount, true);
+}
+#endif
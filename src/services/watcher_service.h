@@ -0,0 +1,284 @@
+#ifndef WATCHER_SERVICE_H
+#define WATCHER_SERVICE_H
+
+#include <QThread>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QFileSystemWatcher>
+#include <QMutex>
+#include <QHash>
+#include <QSet>
+#include <QVector>
+#include <QAtomicInt>
+#include <QElapsedTimer>
+#include <QQueue>
+#include <QThreadPool>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "../core/debounce_wheel.h"
+#include "../core/exclusion_matcher.h"
+#include "../core/file_event.h"
+#include "../core/file_manifest.h"
+#include "polling_scanner.h"
+
+class InotifyWatcher;
+class FanotifyWatcher;
+class QTimer;
+template <typename T> class QFutureWatcher;
+
+// Configuration constants
+namespace WatcherConfig {
+    constexpr qint64 DUPLICATE_EVENT_THRESHOLD_MS = 500;
+    // Beyond this many pending paths in a root new events skip the debounce
+    constexpr int MAX_DEBOUNCED_PATHS = 100000;
+    // Events for the same path within this window are delivered as one
+    constexpr int DEFAULT_COALESCE_WINDOW_MS = 100;
+    // A root's batch is delivered early once this many paths are pending
+    constexpr int MAX_BATCH_EVENTS = 4096;
+    // New directory trees are registered in slices of about this long so
+    // event delivery keeps going during large extracts
+    constexpr qint64 SCAN_SLICE_MS = 8;
+}
+
+/**
+ * @brief WatcherService monitors the source roots of every system at once
+ *
+ * A single thread with a single kernel event source serves all systems.
+ * On Linux it uses a native inotify backend that watches directories only;
+ * elsewhere (or if inotify is unavailable) it falls back to one shared
+ * QFileSystemWatcher. Watches are registered once per path, so overlapping
+ * or identical roots share them, and each event is routed to every root
+ * containing it, found by walking up the path's ancestors (deepest root
+ * first) and checked against that root's exclusion rules.
+ *
+ * Roots that are a dedicated mount can be watched as a whole: on Linux one
+ * fanotify mark per file system replaces the per-directory watches, so
+ * setup time does not depend on the tree size. Its events are routed to
+ * those roots only. Without fanotify (or the privileges it needs) these
+ * roots fall back to the native backend.
+ *
+ * Roots on file systems without change notifications (network mounts)
+ * can be polled instead: they get no kernel watches and take no routed
+ * events, a PollingScanner compares them with an index every poll interval
+ * on a private thread pool, and its findings enter the same pipeline.
+ *
+ * Directories that appear while watching are registered incrementally:
+ * each one is queued, and when its turn comes it is watched first and
+ * listed second, so a file created meanwhile either raises an event or is
+ * found by the listing. Its files are reported as created and its
+ * subdirectories queued in turn, a few milliseconds of work per slice.
+ *
+ * Per root, each path is debounced until its writes settle, then events
+ * are coalesced over a short window and delivered as one batch, so mass
+ * changes such as a checkout cost one queued call per window instead of
+ * one per file. Thread-safe implementation with proper resource management.
+ */
+class WatcherService : public QThread {
+    Q_OBJECT
+
+public:
+    /**
+     * @brief How a root learns about changes
+     */
+    enum class WatchMode {
+        // Kernel notifications (inotify or QFileSystemWatcher)
+        Native,
+        // Periodic stat scans, for mounts that deliver no notifications
+        Polling,
+        // One fanotify mark for the whole file system holding the root
+        Mount
+    };
+
+    /**
+     * @brief One system's source tree
+     */
+    struct Root {
+        int systemIndex = -1;
+        QString systemName;
+        QString path;
+        WatchMode mode = WatchMode::Native;
+        // Compiled exclusion rules for this system
+        ExclusionMatcher exclusions;
+        // Scan of path used to register watches without walking the tree
+        // again (optional); released once watches are registered
+        std::shared_ptr<const FileManifest> manifest;
+    };
+
+    explicit WatcherService(QObject* parent = nullptr);
+    ~WatcherService() override;
+
+    // Delete copy constructor and assignment operator
+    WatcherService(const WatcherService&) = delete;
+    WatcherService& operator=(const WatcherService&) = delete;
+
+    /**
+     * @brief Adds a root to watch. Call before start().
+     */
+    void addRoot(const Root& root);
+
+    /**
+     * @brief Checks whether a system has a root in this service
+     */
+    bool hasSystem(int systemIndex) const;
+
+    int rootCount() const { return int(m_roots.size()); }
+
+    /**
+     * @brief Stops the watcher thread safely
+     */
+    void stop();
+
+    /**
+     * @brief Sets how long events are collected before a batch is delivered
+     * @param ms Window in milliseconds; 0 still merges events that arrive
+     *        together. Call before start().
+     */
+    void setCoalesceWindow(int ms) { m_coalesceWindowMs = qMax(0, ms); }
+
+    /**
+     * @brief Sets how long a path must stay quiet before its event is reported
+     * @param ms Quiet period in milliseconds; 0 disables debouncing.
+     *        Call before start().
+     */
+    void setDebounceInterval(qint64 ms) { m_debounceMs = qMax<qint64>(0, ms); }
+
+    /**
+     * @brief Sets how often polled roots are scanned. Call before start().
+     */
+    void setPollInterval(int ms) { m_pollIntervalMs = qMax(PollingConfig::MIN_INTERVAL_MS, ms); }
+
+    /**
+     * @brief Number of paths (files and directories) currently registered
+     * with the underlying watcher backend. Safe to call from any thread.
+     */
+    int watchedPathCount() const { return m_watchedPathCount.loadRelaxed(); }
+
+signals:
+    void startedWatching();
+    void stoppedWatching();
+    void preloadComplete();
+    void fileEvents(int systemIndex, const FileEventBatch& events);
+    // systemIndex is -1 for messages about the service as a whole
+    void logMessage(int systemIndex, const QString& message);
+
+protected:
+    void run() override;
+
+private:
+    struct RootState {
+        Root config;
+        DebounceWheel debounce;
+        FileEventCoalescer coalescer;
+
+        // Polled roots only
+        std::unique_ptr<PollingScanner> poller;
+        QFutureWatcher<FileEventBatch>* pollWatcher = nullptr;
+        int pollScans = 0;
+        qint64 pollTotalMs = 0;
+        qint64 pollMaxMs = 0;
+    };
+
+    // A directory waiting to be registered and listed
+    struct PendingScan {
+        QString path;
+        // Roots including the directory
+        QVector<int> roots;
+        // Native: watch it before listing; Mount: already covered
+        WatchMode source = WatchMode::Native;
+        // Everything below is new to the roots, so every file is reported
+        // and every subdirectory listed; otherwise only unwatched entries
+        bool newTree = true;
+    };
+
+    bool isStopping() const;
+
+    // Indices of the roots fed by source that contain path, deepest root first
+    QVector<int> rootsContaining(const QString& path, WatchMode source = WatchMode::Native) const;
+    // Those of rootsContaining() whose rules do not exclude path
+    QVector<int> rootsIncluding(const QString& path, WatchMode source = WatchMode::Native) const;
+    // Hands a root over to the native backend
+    void demoteToNative(int rootIndex);
+
+    void addWatchRecursively(int rootIndex);
+    bool addWatchPath(const QString& path, bool isDir);
+    void removeWatchPath(const QString& path);
+    void updateWatchedPathCount();
+    void handleFileChanged(const QString& path);
+    void handleDirectoryChanged(const QString& path);
+    void enqueueScan(const QString& path, const QVector<int>& roots, WatchMode source, bool newTree);
+    void processPendingScans();
+    void scanDirectory(const PendingScan& scan);
+    bool isWatchedDirectory(const QString& path) const;
+
+    void queueEvent(int rootIndex, const QString& path, FileEvent::Kind kind);
+    void queueEvent(const QString& path, FileEvent::Kind kind, WatchMode source = WatchMode::Native);
+    void queueRename(int rootIndex, const QString& oldPath, const QString& newPath, bool isDirectory);
+    // Reports a directory that left the root, so its files are dropped
+    void queueDirectoryRemoval(int rootIndex, const QString& path);
+    void queueDirectoryRemoval(const QString& path, WatchMode source);
+    void releaseSettledEvents();
+    void addToBatch(int rootIndex, const QString& path, FileEvent::Kind kind);
+    void scheduleFlush(int rootIndex);
+    void flushEvents();
+    void flushRoot(int rootIndex);
+    bool startPolling();
+    void pollRoots();
+    void finishPoll(int rootIndex);
+    void stopPolling();
+#ifdef Q_OS_LINUX
+    bool startNativeBackend();
+    bool startMountBackend();
+    void handleMountDirectoryRenamed(const QString& oldPath, const QString& newPath);
+    // Queues a scan reporting the files below path as created to roots
+    void reportFilesBelow(const QString& path, const QVector<int>& roots);
+    // Watches path and its subdirectories included by any of roots
+    int addDirectoryWatchesRecursively(const QString& path, const QVector<int>& roots);
+    void handleNativeDirectoryCreated(const QString& path);
+    void handleFileRenamed(const QString& oldPath, const QString& newPath, WatchMode source);
+    void handleNativeDirectoryRenamed(const QString& oldPath, const QString& newPath);
+#endif
+
+    std::vector<RootState> m_roots;
+    // Natively watched root indices by cleaned root path; several systems
+    // may share a root
+    QHash<QString, QVector<int>> m_rootsByPath;
+    // Whole-mount roots, fed by m_fanotify
+    QHash<QString, QVector<int>> m_mountRootsByPath;
+
+    // Using raw pointer because QFileSystemWatcher must be created in the thread
+    QFileSystemWatcher* m_watcher;
+    InotifyWatcher* m_inotify;
+    FanotifyWatcher* m_fanotify;
+
+    // Registry of paths added to m_watcher, owned by the watcher thread.
+    // Avoids copying QFileSystemWatcher::files()/directories() per event.
+    QSet<QString> m_watchedFiles;
+    QSet<QString> m_watchedDirectories;
+    QAtomicInt m_watchedPathCount;
+
+    bool m_running;
+    mutable QMutex m_mutex;
+
+    // Pending events, owned by the watcher thread
+    QTimer* m_debounceTimer;
+    QElapsedTimer m_clock;
+    qint64 m_debounceMs;
+    QTimer* m_flushTimer;
+    int m_coalesceWindowMs;
+
+    // New directories waiting for registration, owned by the watcher thread
+    QQueue<PendingScan> m_pendingScans;
+    QSet<QString> m_pendingScanPaths;
+    QTimer* m_scanTimer;
+
+    // Polling, scans run on m_pollPool and are applied on the watcher thread
+    QTimer* m_pollTimer;
+    int m_pollIntervalMs;
+    QThreadPool m_pollPool;
+    std::atomic<bool> m_pollCancelled;
+};
+
+#endif // WATCHER_SERVICE_H
@@ -1,6 +1,8 @@
 #include "file_diff_dialog.h"
 #include "../widgets/custom_text_edit.h"
 #include "../../config.h"
+#include "../../utils/mapped_file.h"
+#include "../../core/line_diff.h"
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QSplitter>
@@ -9,9 +11,13 @@
 #include <QTextCursor>
 #include <QTextCharFormat>
 #include <QTextBlock>
+#include <QTextDocument>
 #include <QColor>
 #include <QTimer>
 #include <QFile>
+#include <QFileInfo>
+#include <QFutureWatcher>
+#include <QtConcurrent/QtConcurrent>
 #include <QDateTime>
 #include <QMap>
 #include <QScrollBar>
@@ -24,7 +30,14 @@ FileDiffDialog::FileDiffDialog(QWidget* parent)
       m_newContentEdit(new CustomTextEdit()),
       m_splitter(new QSplitter(Qt::Horizontal)),
       m_refreshTimer(new QTimer(this)),
+      m_statTimer(new QTimer(this)),
       m_statusLabel(new QLabel("")),
+      m_watched(false),
+      m_lastSize(-1),
+      m_lastModifiedMs(-1),
+      m_newLineCount(0),
+      m_diffWatcher(new QFutureWatcher<DiffViewPtr>(this)),
+      m_diffPending(false),
       m_syncingScroll(false)
 {
     setWindowTitle("File Diff Viewer - Live");
@@ -74,7 +87,7 @@ FileDiffDialog::FileDiffDialog(QWidget* parent)
     m_splitter->setSizes(sizes);
 
     m_statusLabel->setStyleSheet("color: #888888; font-size: 9pt;");
-    m_statusLabel->setText("🔄 Auto-refresh enabled");
+    setStatus("🔄 Auto-refresh enabled");
 
     QPushButton* closeButton = new QPushButton("Close", this);
     closeButton->setStyleSheet("background-color: #0B57D0; color: white; padding: 6px 16px; border-radius: 4px;");
@@ -112,10 +125,16 @@ FileDiffDialog::FileDiffDialog(QWidget* parent)
                 m_syncingScroll = false;
             });
     
-    // Use configurable refresh interval
-    int refreshInterval = AppConfig::instance().autoRefreshInterval();
-    m_refreshTimer->setInterval(refreshInterval);
+    connect(m_diffWatcher, &QFutureWatcher<DiffViewPtr>::finished, this, &FileDiffDialog::finishDiff);
+    
+    m_refreshTimer->setSingleShot(true);
+    m_refreshTimer->setInterval(FileDiffConfig::REFRESH_DEBOUNCE_MS);
     connect(m_refreshTimer, &QTimer::timeout, this, &FileDiffDialog::refreshContent);
+    
+    // Use configurable refresh interval for files nobody reports changes of
+    int refreshInterval = AppConfig::instance().autoRefreshInterval();
+    m_statTimer->setInterval(refreshInterval);
+    connect(m_statTimer, &QTimer::timeout, this, &FileDiffDialog::checkFileStamp);
 }
 
 void FileDiffDialog::setFiles(const QString& oldFilePath, const QString& newFilePath)
@@ -123,24 +142,103 @@ void FileDiffDialog::setFiles(const QString& oldFilePath, const QString& newFile
     setWindowTitle(QString("Diff: %1 vs %2").arg(oldFilePath, newFilePath));
 }
 
+FileDiffDialog::~FileDiffDialog()
+{
+    // The worker only holds copies of the texts; stop it early anyway
+    if (m_diffCancelled) {
+        *m_diffCancelled = true;
+    }
+    m_diffWatcher->waitForFinished();
+}
+
 void FileDiffDialog::setContent(const QString& oldContent, const QString& newContent)
 {
-    // highlightDifferences will set the content and add padding
-    highlightDifferences(oldContent, newContent);
+    // The worker sets the content and adds padding
+    startDiff(oldContent, newContent);
 }
 
-void FileDiffDialog::setLiveFile(const QString& filePath, const QString& oldContent)
+void FileDiffDialog::setLiveFile(const QString& filePath, const QString& oldContent, bool watched)
 {
     m_filePath = filePath;
     m_baselineContent = oldContent;
+    
+    // Stamp before reading, so a write in between is seen on the next check
+    const QFileInfo info(filePath);
+    m_lastSize = info.size();
+    m_lastModifiedMs = info.lastModified().toMSecsSinceEpoch();
     m_lastContent = readFileContent(filePath);
     
-    // highlightDifferences will set the content and add padding
-    highlightDifferences(m_baselineContent, m_lastContent);
+    // Don't show the previous file while this one is being diffed
+    m_oldContentEdit->clear();
+    m_newContentEdit->clear();
+    m_rows.clear();
+    startDiff(m_baselineContent, m_lastContent);
+    
+    m_refreshTimer->stop();
+    setWatched(watched);
+}
+
+void FileDiffDialog::setWatched(bool watched)
+{
+    m_watched = watched;
+    if (m_filePath.isEmpty()) {
+        return;
+    }
+    
+    if (watched) {
+        m_statTimer->stop();
+        setStatus("🔄 Auto-refresh: On change");
+    } else {
+        // A hidden dialog starts checking once it is shown again
+        if (isVisible()) {
+            m_statTimer->start();
+        }
+        setStatus("🔄 Auto-refresh: Active");
+    }
+}
+
+void FileDiffDialog::notifyFileChanged()
+{
+    if (m_filePath.isEmpty() || !isVisible()) {
+        return;
+    }
     
-    // Start auto-refresh
+    // Restarting the timer folds a burst of notifications into one read
     m_refreshTimer->start();
-    m_statusLabel->setText("🔄 Auto-refresh: Active");
+}
+
+void FileDiffDialog::checkFileStamp()
+{
+    if (m_filePath.isEmpty()) {
+        return;
+    }
+    
+    const QFileInfo info(m_filePath);
+    const qint64 size = info.exists() ? info.size() : -1;
+    const qint64 modifiedMs = info.exists() ? info.lastModified().toMSecsSinceEpoch() : -1;
+    if (size == m_lastSize && modifiedMs == m_lastModifiedMs) {
+        return;
+    }
+    
+    m_lastSize = size;
+    m_lastModifiedMs = modifiedMs;
+    refreshContent();
+}
+
+void FileDiffDialog::showEvent(QShowEvent* event)
+{
+    QDialog::showEvent(event);
+    if (!m_filePath.isEmpty() && !m_watched) {
+        m_statTimer->start();
+    }
+}
+
+void FileDiffDialog::hideEvent(QHideEvent* event)
+{
+    // A closed diff must not keep reading its file
+    m_refreshTimer->stop();
+    m_statTimer->stop();
+    QDialog::hideEvent(event);
 }
 
 void FileDiffDialog::refreshContent()
@@ -159,224 +257,333 @@ void FileDiffDialog::refreshContent()
         }
     }
     
+    // Patch only the rows the edit touched, unless the rows are about to
+    // be replaced anyway
+    if (m_diffPending) {
+        startDiff(m_baselineContent, currentContent);
+    } else {
+        updateLiveDiff(currentContent);
+    }
     m_lastContent = currentContent;
-    highlightDifferences(m_baselineContent, currentContent);
     
     QString timestamp = QDateTime::currentDateTime().toString("hh:mm:ss");
-    m_statusLabel->setText(QString("🔄 Updated: %1").arg(timestamp));
+    setStatus(QString("🔄 Updated: %1").arg(timestamp));
+}
+
+void FileDiffDialog::setStatus(const QString& text)
+{
+    m_statusText = text;
+    if (!m_diffPending) {
+        m_statusLabel->setText(text);
+    }
+}
+
+void FileDiffDialog::startDiff(const QString& oldContent, const QString& newContent)
+{
+    // A newer version supersedes whatever is still being computed
+    if (m_diffCancelled) {
+        *m_diffCancelled = true;
+    }
+    auto cancelled = std::make_shared<std::atomic<bool>>(false);
+    m_diffCancelled = cancelled;
+    m_diffPending = true;
+    m_statusLabel->setText("⏳ Computing diff...");
+    
+    m_diffWatcher->setFuture(QtConcurrent::run([oldContent, newContent, cancelled]() {
+        return buildDiffView(oldContent, newContent, cancelled.get());
+    }));
 }
 
-void FileDiffDialog::highlightDifferences(const QString& oldContent, const QString& newContent)
+FileDiffDialog::DiffViewPtr FileDiffDialog::buildDiffView(const QString& oldContent, const QString& newContent,
+                                                          const std::atomic<bool>* cancelled)
 {
+    auto view = std::make_shared<DiffView>();
+    view->oldLines = oldContent.split('\n');
+    const QStringList newLines = newContent.split('\n');
+    view->newLineCount = int(newLines.size());
+    
     // Quick check - if identical, no need to process
     if (oldContent == newContent) {
-        m_oldContentEdit->setPlainText(oldContent);
-        m_newContentEdit->setPlainText(newContent);
-        return;
+        view->identical = true;
+        view->rows.reserve(view->newLineCount);
+        for (int i = 0; i < view->newLineCount; ++i) {
+            view->rows.append(DiffRow{RowKind::Same, i, i});
+        }
+        view->alignedOld = oldContent;
+        view->alignedNew = newContent;
+        return view;
     }
     
-    QStringList oldLines = oldContent.split('\n');
-    QStringList newLines = newContent.split('\n');
+    const QVector<DiffHunk> hunks = LineDiff::compute(oldContent, newContent,
+                                                      LineDiff::Algorithm::Histogram, cancelled);
+    if (cancelled->load()) {
+        return nullptr;
+    }
+    appendRows(hunks, 0, int(view->oldLines.size()), 0, view->newLineCount, &view->rows);
     
     // Build aligned versions with empty lines inserted where needed
     QStringList alignedOld;
     QStringList alignedNew;
-    
-    int oldIdx = 0;
-    int newIdx = 0;
-    
-    // Alignment algorithm (same as before but with better comments)
-    while (oldIdx < oldLines.size() || newIdx < newLines.size()) {
-        if (oldIdx < oldLines.size() && newIdx < newLines.size() && 
-            oldLines[oldIdx] == newLines[newIdx]) {
-            // Lines match - add both
-            alignedOld.append(oldLines[oldIdx]);
-            alignedNew.append(newLines[newIdx]);
-            oldIdx++;
-            newIdx++;
-        }
-        else if (oldIdx >= oldLines.size() && newIdx < newLines.size()) {
-            // Old exhausted - add remaining new lines
-            alignedOld.append("");
-            alignedNew.append(newLines[newIdx]);
-            newIdx++;
-        }
-        else if (newIdx >= newLines.size() && oldIdx < oldLines.size()) {
-            // New exhausted - add remaining old lines
-            alignedOld.append(oldLines[oldIdx]);
-            alignedNew.append("");
-            oldIdx++;
-        }
-        else {
-            // Both have content but don't match - look ahead
-            int oldLookAhead = -1;
-            int newLookAhead = -1;
-            
-            // Search next 5 lines for a match
-            for (int i = 1; i <= 5 && oldIdx + i < oldLines.size(); i++) {
-                for (int j = 0; j <= 5 && newIdx + j < newLines.size(); j++) {
-                    if (oldLines[oldIdx + i] == newLines[newIdx + j]) {
-                        oldLookAhead = i;
-                        newLookAhead = j;
-                        break;
-                    }
-                }
-                if (oldLookAhead >= 0) break;
-            }
-            
-            if (oldLookAhead >= 0 && newLookAhead >= 0) {
-                // Found match - insert padding
-                if (oldLookAhead < newLookAhead) {
-                    for (int i = 0; i < newLookAhead; i++) {
-                        if (i < oldLookAhead) {
-                            alignedOld.append(oldLines[oldIdx++]);
-                        } else {
-                            alignedOld.append("");
-                        }
-                        if (newIdx < newLines.size()) {
-                            alignedNew.append(newLines[newIdx++]);
-                        }
-                    }
-                } else {
-                    for (int i = 0; i < oldLookAhead; i++) {
-                        if (oldIdx < oldLines.size()) {
-                            alignedOld.append(oldLines[oldIdx++]);
-                        }
-                        if (i < newLookAhead) {
-                            alignedNew.append(newLines[newIdx++]);
-                        } else {
-                            alignedNew.append("");
-                        }
-                    }
-                }
-            } else {
-                // No match found - treat as modification or separate add/remove
-                bool oldHasMore = (oldIdx < oldLines.size());
-                bool newHasMore = (newIdx < newLines.size());
-                
-                if (oldHasMore && newHasMore) {
-                    QString oldLine = oldLines[oldIdx].trimmed();
-                    QString newLine = newLines[newIdx].trimmed();
-                    
-                    if (oldLine.isEmpty() || newLine.isEmpty() || 
-                        (oldLine != newLine && oldLine.length() > 3 && newLine.length() > 3)) {
-                        // Separate rows
-                        alignedOld.append(oldLines[oldIdx++]);
-                        alignedNew.append("");
-                    } else {
-                        // Same row (modified)
-                        alignedOld.append(oldLines[oldIdx++]);
-                        alignedNew.append(newLines[newIdx++]);
-                    }
-                } else if (oldHasMore) {
-                    alignedOld.append(oldLines[oldIdx++]);
-                    alignedNew.append("");
-                } else if (newHasMore) {
-                    alignedOld.append("");
-                    alignedNew.append(newLines[newIdx++]);
-                } else {
-                    break;
-                }
-            }
-        }
-    }
-    
-    // Ensure alignment
-    while (alignedOld.size() < alignedNew.size()) {
-        alignedOld.append("");
+    alignedOld.reserve(view->rows.size());
+    alignedNew.reserve(view->rows.size());
+    for (const DiffRow& row : view->rows) {
+        alignedOld.append(row.oldLine >= 0 ? view->oldLines[row.oldLine] : QString());
+        alignedNew.append(row.newLine >= 0 ? newLines[row.newLine] : QString());
     }
-    while (alignedNew.size() < alignedOld.size()) {
-        alignedNew.append("");
+    view->alignedOld = alignedOld.join('\n');
+    view->alignedNew = alignedNew.join('\n');
+    return view;
+}
+
+void FileDiffDialog::finishDiff()
+{
+    const DiffViewPtr view = m_diffWatcher->result();
+    if (!view) {
+        // Superseded; its successor reports in on its own
+        return;
     }
     
+    m_diffPending = false;
+    m_oldLines = view->oldLines;
+    m_newLineCount = view->newLineCount;
+    m_rows = view->rows;
+    
     // Batch update for performance
     m_oldContentEdit->setUpdatesEnabled(false);
     m_newContentEdit->setUpdatesEnabled(false);
     
-    m_oldContentEdit->setPlainText(alignedOld.join('\n'));
-    m_newContentEdit->setPlainText(alignedNew.join('\n'));
+    m_oldContentEdit->setPlainText(view->alignedOld);
+    m_newContentEdit->setPlainText(view->alignedNew);
     
     // Apply highlighting
-    applyHighlighting(alignedOld, alignedNew);
+    if (!view->identical) {
+        applyHighlighting(0, int(m_rows.size()));
+    }
     
     m_oldContentEdit->setUpdatesEnabled(true);
     m_newContentEdit->setUpdatesEnabled(true);
+    m_statusLabel->setText(m_statusText);
 }
 
-void FileDiffDialog::applyHighlighting(const QStringList& oldLines, const QStringList& newLines)
+void FileDiffDialog::updateLiveDiff(const QString& currentContent)
 {
-    QColor redBg(220, 38, 38, 60);
-    QColor greenBg(34, 197, 94, 60);
-    QColor orangeBg(251, 140, 0, 60);
-    QColor darkBg(30, 30, 30);
+    // Only the lines between the unchanged head and tail of the file can
+    // change their alignment
+    int prefixLines = 0;
+    int suffixLines = 0;
+    LineDiff::commonLines(m_lastContent, currentContent, &prefixLines, &suffixLines);
+    const int currentLineCount = int(currentContent.count(QLatin1Char('\n'))) + 1;
+    const int lineDelta = currentLineCount - m_newLineCount;
+    
+    // Rows holding the changed lines, widened to the unchanged rows around
+    // their hunks so the region is re-diffed as a whole
+    const int rowCount = int(m_rows.size());
+    int rowBegin = rowOfNewLine(prefixLines);
+    int rowEnd = rowOfNewLine(m_newLineCount - suffixLines);
+    while (rowBegin > 0 && m_rows[rowBegin - 1].kind != RowKind::Same) {
+        --rowBegin;
+    }
+    while (rowEnd < rowCount && m_rows[rowEnd].kind != RowKind::Same) {
+        ++rowEnd;
+    }
     
-    QTextCursor oldCursor(m_oldContentEdit->document());
-    QTextCursor newCursor(m_newContentEdit->document());
+    const int oldBegin = rowBegin > 0 ? m_rows[rowBegin - 1].oldLine + 1 : 0;
+    const int newBegin = rowBegin > 0 ? m_rows[rowBegin - 1].newLine + 1 : 0;
+    const int oldEnd = rowEnd < rowCount ? m_rows[rowEnd].oldLine : int(m_oldLines.size());
+    const int newEnd = (rowEnd < rowCount ? m_rows[rowEnd].newLine : m_newLineCount) + lineDelta;
     
-    oldCursor.movePosition(QTextCursor::Start);
-    newCursor.movePosition(QTextCursor::Start);
+    // Large regions are diffed on the worker like a fresh file
+    if ((rowBegin == 0 && rowEnd == rowCount)
+        || (oldEnd - oldBegin) + (newEnd - newBegin) > FileDiffConfig::MAX_INLINE_DIFF_LINES) {
+        startDiff(m_baselineContent, currentContent);
+        return;
+    }
     
-    for (int i = 0; i < oldLines.size(); ++i) {
-        QString oldLine = oldLines[i];
-        QString newLine = i < newLines.size() ? newLines[i] : "";
-        
-        bool oldEmpty = oldLine.isEmpty();
-        bool newEmpty = newLine.isEmpty();
-        bool linesMatch = (oldLine == newLine);
-        
-        // Highlight old content line
-        oldCursor.select(QTextCursor::LineUnderCursor);
-        QTextCharFormat oldFormat;
+    const QStringList oldRegion = m_oldLines.mid(oldBegin, oldEnd - oldBegin);
+    const QString newText = lineRange(currentContent, newBegin, newEnd).toString();
+    const QStringList newRegion = newEnd > newBegin ? newText.split('\n') : QStringList();
+    
+    QVector<DiffHunk> hunks;
+    if (!oldRegion.isEmpty() && !newRegion.isEmpty()) {
+        hunks = LineDiff::compute(oldRegion.join('\n'), newText);
+    } else if (!oldRegion.isEmpty() || !newRegion.isEmpty()) {
+        DiffHunk hunk;
+        hunk.oldCount = int(oldRegion.size());
+        hunk.newCount = int(newRegion.size());
+        hunks.append(hunk);
+    }
+    
+    QVector<DiffRow> regionRows;
+    appendRows(hunks, oldBegin, oldEnd, newBegin, newEnd, &regionRows);
+    
+    QStringList alignedOld;
+    QStringList alignedNew;
+    for (const DiffRow& row : regionRows) {
+        alignedOld.append(row.oldLine >= 0 ? m_oldLines[row.oldLine] : QString());
+        alignedNew.append(row.newLine >= 0 ? newRegion[row.newLine - newBegin] : QString());
+    }
+    
+    // Patch the rows of both documents in place; scroll positions and the
+    // rest of the text stay untouched
+    replaceRows(m_oldContentEdit, rowBegin, rowEnd, alignedOld);
+    replaceRows(m_newContentEdit, rowBegin, rowEnd, alignedNew);
+    
+    QVector<DiffRow> rows;
+    rows.reserve(rowBegin + regionRows.size() + rowCount - rowEnd);
+    rows.append(m_rows.mid(0, rowBegin));
+    rows.append(regionRows);
+    for (int i = rowEnd; i < rowCount; ++i) {
+        DiffRow row = m_rows[i];
+        if (row.newLine >= 0) {
+            row.newLine += lineDelta;
+        }
+        rows.append(row);
+    }
+    m_rows = rows;
+    m_newLineCount = currentLineCount;
+    
+    applyHighlighting(rowBegin, int(regionRows.size()));
+}
+
+void FileDiffDialog::appendRows(const QVector<DiffHunk>& hunks, int oldBegin, int oldEnd,
+                                int newBegin, int newEnd, QVector<DiffRow>* rows)
+{
+    int oldIdx = oldBegin;
+    int newIdx = newBegin;
+    for (const DiffHunk& hunk : hunks) {
+        // Unchanged lines up to the hunk
+        while (oldIdx < oldBegin + hunk.oldStart) {
+            rows->append(DiffRow{RowKind::Same, oldIdx++, newIdx++});
+        }
         
-        if (oldEmpty && !newEmpty) {
-            oldFormat.setBackground(QBrush(redBg));
-        } else if (!oldEmpty && newEmpty) {
-            oldFormat.setBackground(QBrush(redBg));
-        } else if (linesMatch) {
-            oldFormat.setBackground(QBrush(darkBg));
-        } else if (!oldEmpty && !newEmpty) {
-            oldFormat.setBackground(QBrush(orangeBg));
+        // Replaced lines side by side, the longer side against padding
+        const int paired = qMin(hunk.oldCount, hunk.newCount);
+        for (int i = 0; i < paired; ++i) {
+            rows->append(DiffRow{RowKind::Modified, oldIdx++, newIdx++});
+        }
+        for (int i = paired; i < hunk.oldCount; ++i) {
+            rows->append(DiffRow{RowKind::Removed, oldIdx++, -1});
+        }
+        for (int i = paired; i < hunk.newCount; ++i) {
+            rows->append(DiffRow{RowKind::Added, -1, newIdx++});
+        }
+    }
+    while (oldIdx < oldEnd && newIdx < newEnd) {
+        rows->append(DiffRow{RowKind::Same, oldIdx++, newIdx++});
+    }
+}
+
+int FileDiffDialog::rowOfNewLine(int line) const
+{
+    // New line numbers ascend through the rows, padding rows aside
+    int row = 0;
+    while (row < m_rows.size() && (m_rows[row].newLine < 0 || m_rows[row].newLine < line)) {
+        ++row;
+    }
+    return row;
+}
+
+QStringView FileDiffDialog::lineRange(QStringView text, int firstLine, int endLine)
+{
+    if (endLine <= firstLine) {
+        return QStringView();
+    }
+    
+    qsizetype start = 0;
+    for (int line = 0; line < firstLine; ++line) {
+        start = text.indexOf(QLatin1Char('\n'), start) + 1;
+    }
+    qsizetype end = start;
+    for (int line = firstLine; line < endLine - 1; ++line) {
+        end = text.indexOf(QLatin1Char('\n'), end) + 1;
+    }
+    end = text.indexOf(QLatin1Char('\n'), end);
+    return text.mid(start, (end < 0 ? text.size() : end) - start);
+}
+
+void FileDiffDialog::replaceRows(CustomTextEdit* edit, int rowBegin, int rowEnd, const QStringList& lines)
+{
+    QTextDocument* document = edit->document();
+    const int blockCount = document->blockCount();
+    QTextCursor cursor(document);
+    cursor.beginEditBlock();
+    
+    if (rowBegin < rowEnd) {
+        // The rows without the newline after the last one
+        qsizetype start = document->findBlockByNumber(rowBegin).position();
+        const QTextBlock last = document->findBlockByNumber(rowEnd - 1);
+        qsizetype end = last.position() + last.length() - 1;
+        if (lines.isEmpty()) {
+            // Take one separator along so no empty row is left behind
+            if (rowEnd < blockCount) {
+                ++end;
+            } else {
+                --start;
+            }
+        }
+        cursor.setPosition(int(start));
+        cursor.setPosition(int(end), QTextCursor::KeepAnchor);
+        cursor.removeSelectedText();
+        if (!lines.isEmpty()) {
+            cursor.insertText(lines.join('\n'), QTextCharFormat());
+        }
+    } else if (!lines.isEmpty()) {
+        if (rowBegin < blockCount) {
+            cursor.setPosition(document->findBlockByNumber(rowBegin).position());
+            cursor.insertText(lines.join('\n') + '\n', QTextCharFormat());
         } else {
-            oldFormat.setBackground(QBrush(darkBg));
+            cursor.movePosition(QTextCursor::End);
+            cursor.insertText('\n' + lines.join('\n'), QTextCharFormat());
         }
+    }
+    
+    cursor.endEditBlock();
+}
+
+void FileDiffDialog::applyHighlighting(int firstRow, int rowCount)
+{
+    if (rowCount <= 0) {
+        return;
+    }
+    
+    QColor redBg(220, 38, 38, 60);
+    QColor greenBg(34, 197, 94, 60);
+    QColor orangeBg(251, 140, 0, 60);
+    
+    QTextCharFormat removedFormat;
+    removedFormat.setBackground(QBrush(redBg));
+    QTextCharFormat addedFormat;
+    addedFormat.setBackground(QBrush(greenBg));
+    QTextCharFormat modifiedFormat;
+    modifiedFormat.setBackground(QBrush(orangeBg));
+    
+    QTextCursor oldCursor(m_oldContentEdit->document()->findBlockByNumber(firstRow));
+    QTextCursor newCursor(m_newContentEdit->document()->findBlockByNumber(firstRow));
+    
+    for (int i = firstRow; i < firstRow + rowCount; ++i) {
+        const RowKind kind = m_rows[i].kind;
         
-        oldCursor.mergeCharFormat(oldFormat);
-        oldCursor.clearSelection();
-        oldCursor.movePosition(QTextCursor::NextBlock);
-        
-        // Highlight new content line
-        if (i < newLines.size()) {
-            newCursor.select(QTextCursor::LineUnderCursor);
-            QTextCharFormat newFormat;
+        // Unchanged rows keep the editor background
+        if (kind != RowKind::Same) {
+            const bool modified = (kind == RowKind::Modified);
             
-            if (newEmpty && !oldEmpty) {
-                newFormat.setBackground(QBrush(greenBg));
-            } else if (!newEmpty && oldEmpty) {
-                newFormat.setBackground(QBrush(greenBg));
-            } else if (linesMatch) {
-                newFormat.setBackground(QBrush(darkBg));
-            } else if (!oldEmpty && !newEmpty) {
-                newFormat.setBackground(QBrush(orangeBg));
-            } else {
-                newFormat.setBackground(QBrush(darkBg));
-            }
+            oldCursor.select(QTextCursor::LineUnderCursor);
+            oldCursor.mergeCharFormat(modified ? modifiedFormat : removedFormat);
+            oldCursor.clearSelection();
             
-            newCursor.mergeCharFormat(newFormat);
+            newCursor.select(QTextCursor::LineUnderCursor);
+            newCursor.mergeCharFormat(modified ? modifiedFormat : addedFormat);
             newCursor.clearSelection();
-            newCursor.movePosition(QTextCursor::NextBlock);
         }
+        
+        oldCursor.movePosition(QTextCursor::NextBlock);
+        newCursor.movePosition(QTextCursor::NextBlock);
     }
 }
 
 QString FileDiffDialog::readFileContent(const QString& filePath)
 {
-    QFile file(filePath);
-    if (!file.open(QIODevice::ReadOnly)) {
-        return QString();
-    }
-    QByteArray data = file.readAll();
-    file.close();
-    return QString::fromUtf8(data);
+    return MappedFile::readText(filePath);
 }
 
 void FileDiffDialog::syncOldToNew()
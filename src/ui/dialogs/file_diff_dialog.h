@@ -3,20 +3,49 @@
 
 #include <QDialog>
 #include <QString>
+#include <QStringList>
+#include <QStringView>
+#include <QVector>
+#include <atomic>
+#include <memory>
+
+#include "../../core/line_diff.h"
 
 class CustomTextEdit;
 class QSplitter;
 class QTimer;
 class QLabel;
+class QHideEvent;
+class QShowEvent;
+template <typename T> class QFutureWatcher;
+
+// Configuration constants
+namespace FileDiffConfig {
+    // A notified change is read once no further one arrived for this long
+    constexpr int REFRESH_DEBOUNCE_MS = 150;
+    // Live edits touching more lines than this are re-diffed on the worker
+    constexpr int MAX_INLINE_DIFF_LINES = 2000;
+}
 
 /**
  * @brief Dialog for comparing file differences with auto-refresh
+ *
+ * A live file that the watcher covers is refreshed only when its owner
+ * reports a change through notifyFileChanged(), debounced. Other live files
+ * are stat'ed on the refresh interval and read only when their size or
+ * modification time moved. Nothing is checked while the dialog is hidden.
+ *
+ * Full diffs are computed on a worker thread into an immutable view that
+ * the GUI thread only installs, so a huge file never blocks the event loop.
+ * A newer version cancels the computation still running for an older one.
+ * Small live edits are patched in place on the GUI thread.
  */
 class FileDiffDialog : public QDialog {
     Q_OBJECT
 
 public:
     explicit FileDiffDialog(QWidget* parent = nullptr);
+    ~FileDiffDialog() override;
 
     /**
      * @brief Sets the file paths for comparison
@@ -30,32 +59,116 @@ public:
     
     /**
      * @brief Sets the file path for live monitoring
+     * @param watched Whether changes to the file will be reported through
+     *        notifyFileChanged(); otherwise the file is stat'ed periodically
+     */
+    void setLiveFile(const QString& filePath, const QString& oldContent, bool watched = false);
+
+    const QString& liveFilePath() const { return m_filePath; }
+
+    /**
+     * @brief Switches the live file between notifications and stat checks,
+     * e.g. when watching starts or stops
      */
-    void setLiveFile(const QString& filePath, const QString& oldContent);
+    void setWatched(bool watched);
+
+    /**
+     * @brief Reports that the live file changed; it is read once changes settle
+     */
+    void notifyFileChanged();
+
+protected:
+    void showEvent(QShowEvent* event) override;
+    void hideEvent(QHideEvent* event) override;
 
 signals:
     void logMessage(const QString& message);
 
 private slots:
     void refreshContent();
+    void checkFileStamp();
     void syncOldToNew();
     void syncNewToOld();
 
 private:
-    void highlightDifferences(const QString& oldContent, const QString& newContent);
-    void applyHighlighting(const QStringList& oldLines, const QStringList& newLines);
+    // How a row of the aligned views relates the two sides
+    enum class RowKind {
+        Same,
+        Modified,
+        Removed,
+        Added
+    };
+
+    // One row of the aligned views; a line number is -1 on a padding side
+    struct DiffRow {
+        RowKind kind;
+        int oldLine;
+        int newLine;
+    };
+
+    // Everything the views show for one pair of texts; built on the worker,
+    // never modified afterwards
+    struct DiffView {
+        QStringList oldLines;
+        int newLineCount = 0;
+        QVector<DiffRow> rows;
+        QString alignedOld;
+        QString alignedNew;
+        bool identical = false;
+    };
+    using DiffViewPtr = std::shared_ptr<const DiffView>;
+
+    // Diffs the texts on the worker, superseding any diff still running
+    void startDiff(const QString& oldContent, const QString& newContent);
+    // Returns nullptr once cancelled
+    static DiffViewPtr buildDiffView(const QString& oldContent, const QString& newContent,
+                                     const std::atomic<bool>* cancelled);
+    void finishDiff();
+    // Shows text unless a diff is being computed, then once it is installed
+    void setStatus(const QString& text);
+    // Re-diffs only the rows around the lines that changed since m_lastContent
+    // and patches them into both documents
+    void updateLiveDiff(const QString& currentContent);
+    // Appends the rows for the line ranges [oldBegin, oldEnd) and
+    // [newBegin, newEnd), given hunks relative to their starts
+    static void appendRows(const QVector<DiffHunk>& hunks, int oldBegin, int oldEnd,
+                           int newBegin, int newEnd, QVector<DiffRow>* rows);
+    // First row showing the given new line or a later one
+    int rowOfNewLine(int line) const;
+    static QStringView lineRange(QStringView text, int firstLine, int endLine);
+    static void replaceRows(CustomTextEdit* edit, int rowBegin, int rowEnd, const QStringList& lines);
+    void applyHighlighting(int firstRow, int rowCount);
     QString readFileContent(const QString& filePath);
 
     CustomTextEdit* m_oldContentEdit;
     CustomTextEdit* m_newContentEdit;
     QSplitter* m_splitter;
+    // Single-shot, restarted by each notification
     QTimer* m_refreshTimer;
+    // Periodic stat of unwatched live files
+    QTimer* m_statTimer;
     QLabel* m_statusLabel;
     
     QString m_filePath;
+    bool m_watched;
+    // Size and modification time the stat fallback last saw
+    qint64 m_lastSize;
+    qint64 m_lastModifiedMs;
     QString m_baselineContent;
     QString m_lastContent;
     
+    // Diff state of the current view, kept so live updates can patch it
+    QStringList m_oldLines;
+    int m_newLineCount;
+    QVector<DiffRow> m_rows;
+    
+    QFutureWatcher<DiffViewPtr>* m_diffWatcher;
+    // Flag of the diff last started
+    std::shared_ptr<std::atomic<bool>> m_diffCancelled;
+    // A view is on its way; until then m_rows do not match m_lastContent
+    bool m_diffPending;
+    QString m_statusText;
+    
     bool m_syncingScroll;
 };
 
@@ -34,14 +34,43 @@ LogDialog::LogDialog(QWidget* parent)
 
 void LogDialog::addLog(const QString& message)
 {
-    int row = m_logTable->rowCount();
-    m_logTable->insertRow(row);
+    if (m_batchDepth > 0) {
+        m_pendingMessages << message;
+        return;
+    }
+
+    appendRows({message});
+}
+
+void LogDialog::beginBatch()
+{
+    ++m_batchDepth;
+}
 
-    QTableWidgetItem* timeItem = new QTableWidgetItem(QDateTime::currentDateTime().toString("yyyy-MM-dd hh:mm:ss"));
-    QTableWidgetItem* messageItem = new QTableWidgetItem(message);
+void LogDialog::endBatch()
+{
+    if (m_batchDepth == 0 || --m_batchDepth > 0) {
+        return;
+    }
+
+    QStringList messages;
+    messages.swap(m_pendingMessages);
+    if (!messages.isEmpty()) {
+        appendRows(messages);
+    }
+}
+
+void LogDialog::appendRows(const QStringList& messages)
+{
+    const QString timestamp = QDateTime::currentDateTime().toString("yyyy-MM-dd hh:mm:ss");
+    int row = m_logTable->rowCount();
+    m_logTable->setRowCount(row + messages.size());
 
-    m_logTable->setItem(row, 0, timeItem);
-    m_logTable->setItem(row, 1, messageItem);
+    for (const QString& message : messages) {
+        m_logTable->setItem(row, 0, new QTableWidgetItem(timestamp));
+        m_logTable->setItem(row, 1, new QTableWidgetItem(message));
+        ++row;
+    }
     
     m_logTable->scrollToBottom();
 }
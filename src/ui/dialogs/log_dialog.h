@@ -4,6 +4,7 @@
 #include <QDialog>
 #include <QTableWidget>
 #include <QPushButton>
+#include <QStringList>
 
 /**
  * @brief Dialog for displaying application logs
@@ -19,6 +20,13 @@ public:
      */
     void addLog(const QString& message);
 
+    /**
+     * @brief Holds back entries added until the matching endBatch(), which
+     * inserts them all at once; calls may nest
+     */
+    void beginBatch();
+    void endBatch();
+
     /**
      * @brief Clears all logs
      */
@@ -28,9 +36,13 @@ signals:
     void addLogSignal(const QString& message);
 
 private:
+    void appendRows(const QStringList& messages);
+
     QTableWidget* m_logTable;
     QPushButton* m_clearButton;
     QPushButton* m_closeButton;
+    int m_batchDepth = 0;
+    QStringList m_pendingMessages;
 };
 
 #endif // LOG_DIALOG_H
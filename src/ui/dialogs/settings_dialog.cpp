@@ -29,6 +29,7 @@ SettingsDialog::SettingsDialog(QWidget* parent)
     , m_tokenEdit(new QLineEdit())
     , m_chatIdEdit(new QLineEdit())
     , m_notificationsCheckbox(new QCheckBox("Enable Telegram Notifications"))
+    , m_hashOnlyBaselineCheckbox(new QCheckBox("Low-memory baseline (keep only size and hash of unchanged files)"))
     , m_systemsContainer(new QWidget())
     , m_systemsLayout(new QVBoxLayout())
     , m_withoutTable(new QTableWidget(0, 0))
@@ -42,7 +43,7 @@ SettingsDialog::SettingsDialog(QWidget* parent)
 
     m_tokenEdit->setEchoMode(QLineEdit::Password);
     m_apiUrlEdit->setPlaceholderText("http://khmergaming.436bet.com/app/log_sys.php");
-    m_notificationsCheckbox->setStyleSheet(
+    const QString checkboxStyle =
         "QCheckBox { color: #E1E1E1; spacing: 8px; } "
         "QCheckBox::indicator { "
         "background-color: #2A2A2A; "
@@ -53,8 +54,12 @@ SettingsDialog::SettingsDialog(QWidget* parent)
         "} "
         "QCheckBox::indicator:checked { "
         "image: url(:/icons/checkmark.svg); "
-        "}"
-    );
+        "}";
+    m_notificationsCheckbox->setStyleSheet(checkboxStyle);
+    m_hashOnlyBaselineCheckbox->setStyleSheet(checkboxStyle);
+    m_hashOnlyBaselineCheckbox->setToolTip(
+        "Old content of changed files is recovered from the Git or Destination path "
+        "so the diff viewer keeps working");
 
     QVBoxLayout* mainLayout = new QVBoxLayout(this);
 
@@ -90,6 +95,7 @@ SettingsDialog::SettingsDialog(QWidget* parent)
     systemButtons->addWidget(removeSystemBtn);
     systemButtons->addStretch();
     systemsGroupLayout->addLayout(systemButtons);
+    systemsGroupLayout->addWidget(m_hashOnlyBaselineCheckbox);
 
     m_systemsLayout->setSpacing(12);
     m_systemsContainer->setLayout(m_systemsLayout);
@@ -224,6 +230,16 @@ void SettingsDialog::setNotificationsEnabled(bool enabled)
     m_notificationsCheckbox->setChecked(enabled);
 }
 
+bool SettingsDialog::isHashOnlyBaseline() const
+{
+    return m_hashOnlyBaselineCheckbox->isChecked();
+}
+
+void SettingsDialog::setHashOnlyBaseline(bool enabled)
+{
+    m_hashOnlyBaselineCheckbox->setChecked(enabled);
+}
+
 QVector<SettingsDialog::SystemConfigData> SettingsDialog::systemConfigs() const
 {
     QVector<SystemConfigData> configs;
@@ -236,6 +252,7 @@ QVector<SettingsDialog::SystemConfigData> SettingsDialog::systemConfigs() const
         data.git = row.gitEdit->text();
         data.backup = row.backupEdit->text();
         data.assign = row.assignEdit->text();
+        data.watchMode = row.watchModeCombo->currentData().toString();
         configs.append(data);
     }
     return configs;
@@ -392,6 +409,16 @@ void SettingsDialog::createSystemRowWidget(int index, const SystemConfigData& da
     row.gitEdit = new QLineEdit(data.git, row.groupBox);
     row.backupEdit = new QLineEdit(data.backup, row.groupBox);
     row.assignEdit = new QLineEdit(data.assign, row.groupBox);
+    row.watchModeCombo = new QComboBox(row.groupBox);
+    row.watchModeCombo->addItem("Change notifications", QStringLiteral("native"));
+    row.watchModeCombo->addItem("Polling (network mounts)", QStringLiteral("polling"));
+    row.watchModeCombo->addItem("Whole mount (fanotify, Linux)", QStringLiteral("mount"));
+    row.watchModeCombo->setToolTip(
+        "Use polling for SMB/NFS sources, where change notifications miss remote edits.\n"
+        "Whole mount watches a source that is an entire dedicated file system with one\n"
+        "fanotify mark (needs root); it falls back to change notifications otherwise.");
+    const int modeIndex = row.watchModeCombo->findData(data.watchMode);
+    row.watchModeCombo->setCurrentIndex(modeIndex < 0 ? 0 : modeIndex);
 
     // Connect name edit to update group box title and table headers
     connect(row.nameEdit, &QLineEdit::textChanged, this, [this, groupBox = row.groupBox](const QString& text) {
@@ -415,6 +442,9 @@ void SettingsDialog::createSystemRowWidget(int index, const SystemConfigData& da
     grid->addWidget(new QLabel("Assign:", row.groupBox), 2, 2);
     grid->addWidget(row.assignEdit, 2, 3);
 
+    grid->addWidget(new QLabel("Watch:", row.groupBox), 3, 0);
+    grid->addWidget(row.watchModeCombo, 3, 1);
+
     m_systemRows.append(row);
     m_systemsLayout->addWidget(row.groupBox);
 }
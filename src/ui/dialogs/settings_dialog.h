@@ -4,6 +4,7 @@
 #include <QDialog>
 #include <QLineEdit>
 #include <QCheckBox>
+#include <QComboBox>
 #include <QPushButton>
 #include <QTableWidget>
 #include <QGroupBox>
@@ -26,6 +27,9 @@ public:
         QString git;
         QString backup;
         QString assign;
+        // "native" (change notifications), "polling" (network mounts) or
+        // "mount" (fanotify on a dedicated file system)
+        QString watchMode;
     };
 
     explicit SettingsDialog(QWidget* parent = nullptr);
@@ -62,6 +66,12 @@ public:
     bool isNotificationsEnabled() const;
     void setNotificationsEnabled(bool enabled);
 
+    /**
+     * @brief Checks if baselines keep only size and hash per file
+     */
+    bool isHashOnlyBaseline() const;
+    void setHashOnlyBaseline(bool enabled);
+
     QVector<SystemConfigData> systemConfigs() const;
     void setSystemConfigs(const QVector<SystemConfigData>& configs);
 
@@ -98,6 +108,7 @@ private:
         QLineEdit* gitEdit;
         QLineEdit* backupEdit;
         QLineEdit* assignEdit;
+        QComboBox* watchModeCombo;
     };
 
     void createSystemRowWidget(int index, const SystemConfigData& data);
@@ -114,6 +125,7 @@ private:
     QLineEdit* m_tokenEdit;
     QLineEdit* m_chatIdEdit;
     QCheckBox* m_notificationsCheckbox;
+    QCheckBox* m_hashOnlyBaselineCheckbox;
 
     QWidget* m_systemsContainer;
     QVBoxLayout* m_systemsLayout;
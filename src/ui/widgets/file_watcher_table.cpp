@@ -4,6 +4,9 @@
 #include <QPushButton>
 #include <QHBoxLayout>
 #include <QWidget>
+#include <QSet>
+#include <algorithm>
+#include <functional>
 
 FileWatcherTable::FileWatcherTable(QWidget* parent)
     : QTableWidget(parent)
@@ -65,40 +68,122 @@ void FileWatcherTable::updateFileEntry(const QString& filePath, const QString& s
 void FileWatcherTable::removeFileEntry(const QString& filePath)
 {
     if (m_fileRowMap.contains(filePath)) {
-        int row = m_fileRowMap[filePath];
+        int row = m_fileRowMap.take(filePath);
         removeRow(row);
 
-        // Rebuild the row map since row indices changed
-        m_fileRowMap.clear();
-        for (int i = 0; i < rowCount(); ++i) {
+        // Only the rows below the removed one moved up
+        for (int i = row; i < rowCount(); ++i) {
             if (item(i, 0)) {
                 m_fileRowMap[item(i, 0)->text()] = i;
             }
         }
 
-        m_fileContents.remove(filePath);
+        m_baseline.remove(filePath);
     }
 }
 
-QString FileWatcherTable::getFileContent(const QString& filePath) const
+int FileWatcherTable::renameEntries(const QString& oldPath, const QString& newPath, bool isDirectory)
+{
+    QStringList moved;
+    if (isDirectory) {
+        const QString prefix = oldPath + QLatin1Char('/');
+        QSet<QString> paths;
+        for (const QString& key : m_baseline.keys()) {
+            if (key.startsWith(prefix)) {
+                paths.insert(key);
+            }
+        }
+        for (auto it = m_fileRowMap.constBegin(); it != m_fileRowMap.constEnd(); ++it) {
+            if (it.key().startsWith(prefix)) {
+                paths.insert(it.key());
+            }
+        }
+        moved = QStringList(paths.begin(), paths.end());
+    } else if (m_baseline.contains(oldPath) || m_fileRowMap.contains(oldPath)) {
+        moved << oldPath;
+    }
+
+    for (const QString& from : moved) {
+        const QString to = newPath + from.mid(oldPath.size());
+        m_baseline.rename(from, to);
+
+        const auto rowIt = m_fileRowMap.constFind(from);
+        if (rowIt == m_fileRowMap.constEnd()) {
+            addFileEntry(to, "Renamed");
+            continue;
+        }
+
+        const int row = rowIt.value();
+        const QString status = item(row, 1) ? item(row, 1)->text() : QString("Renamed");
+        if (m_fileRowMap.contains(to)) {
+            removeFileEntry(from);
+            updateFileEntry(to, status);
+            continue;
+        }
+        m_fileRowMap.remove(from);
+        m_fileRowMap.insert(to, row);
+        item(row, 0)->setText(to);
+        item(row, 2)->setText(QDateTime::currentDateTime().toString("yyyy-MM-dd hh:mm:ss"));
+    }
+
+    return moved.size();
+}
+
+int FileWatcherTable::removeEntriesBelow(const QString& dirPath)
 {
-    // Return null QString if no baseline exists (different from empty string "")
-    if (!m_fileContents.contains(filePath)) {
-        return QString(); // null QString indicates "no baseline"
+    const QString prefix = dirPath + QLatin1Char('/');
+    QSet<QString> paths;
+    for (const QString& key : m_baseline.keys()) {
+        if (key.startsWith(prefix)) {
+            paths.insert(key);
+            m_baseline.remove(key);
+        }
+    }
+
+    // Remove rows bottom-up and renumber the survivors once, instead of
+    // once per removed row
+    QList<int> rows;
+    for (auto it = m_fileRowMap.begin(); it != m_fileRowMap.end();) {
+        if (it.key().startsWith(prefix)) {
+            paths.insert(it.key());
+            rows.append(it.value());
+            it = m_fileRowMap.erase(it);
+        } else {
+            ++it;
+        }
     }
-    return m_fileContents.value(filePath);
+    if (!rows.isEmpty()) {
+        std::sort(rows.begin(), rows.end(), std::greater<int>());
+        for (int row : rows) {
+            removeRow(row);
+        }
+        for (int i = rows.last(); i < rowCount(); ++i) {
+            if (item(i, 0)) {
+                m_fileRowMap[item(i, 0)->text()] = i;
+            }
+        }
+    }
+
+    return paths.size();
 }
 
-void FileWatcherTable::setFileContent(const QString& filePath, const QString& content)
+QString FileWatcherTable::getFileContent(const QString& filePath) const
 {
-    m_fileContents[filePath] = content;
+    // Return null QString if no content is available (different from empty string "")
+    const BaselineEntry* entry = m_baseline.find(filePath);
+    if (!entry || !entry->hasContent()) {
+        return QString(); // null QString indicates "no baseline content"
+    }
+    // An empty file still has a baseline, so never hand back a null string
+    const QByteArray data = entry->content.data();
+    return data.isEmpty() ? QString("") : QString::fromUtf8(data);
 }
 
 void FileWatcherTable::clearTable()
 {
     setRowCount(0);
     m_fileRowMap.clear();
-    m_fileContents.clear();
+    m_baseline.clear();
 }
 
 void FileWatcherTable::addDeleteButton(int row)
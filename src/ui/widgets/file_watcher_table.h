@@ -5,6 +5,8 @@
 #include <QMap>
 #include <QString>
 
+#include "../../core/baseline_store.h"
+
 /**
  * @brief Custom table widget for displaying watched files
  */
@@ -30,14 +32,31 @@ public:
     void removeFileEntry(const QString& filePath);
 
     /**
-     * @brief Gets the stored file content
+     * @brief Moves the rows and baselines of a renamed file or directory
+     *
+     * Rows keep their status; baselined files without a row are listed as
+     * "Renamed". No file content is read.
+     * @return Number of files moved
+     */
+    int renameEntries(const QString& oldPath, const QString& newPath, bool isDirectory);
+
+    /**
+     * @brief Removes the rows and baselines of every file below a directory
+     * @return Number of files removed
+     */
+    int removeEntriesBelow(const QString& dirPath);
+
+    /**
+     * @brief Gets the stored baseline content
+     * @return Null QString if there is no baseline or its content was not kept
      */
     QString getFileContent(const QString& filePath) const;
 
     /**
-     * @brief Sets the file content
+     * @brief Baseline fingerprints and retained content for this system
      */
-    void setFileContent(const QString& filePath, const QString& content);
+    BaselineStore& baseline() { return m_baseline; }
+    const BaselineStore& baseline() const { return m_baseline; }
 
     /**
      * @brief Clears the table
@@ -62,7 +81,7 @@ private slots:
 private:
     void addDeleteButton(int row);
 
-    QMap<QString, QString> m_fileContents;
+    BaselineStore m_baseline;
     QMap<QString, int> m_fileRowMap;
 };
 
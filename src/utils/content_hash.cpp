@@ -0,0 +1,379 @@
+#include "content_hash.h"
+#include <QFile>
+#include <QtEndian>
+#include <array>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define CONTENT_HASH_X86_64 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define CONTENT_HASH_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define CONTENT_HASH_TARGET_AVX2
+#endif
+
+namespace {
+    using namespace ContentHashConfig;
+
+    constexpr quint64 PRIME32_1 = 0x9E3779B1ULL;
+    constexpr quint64 PRIME32_2 = 0x85EBCA77ULL;
+    constexpr quint64 PRIME32_3 = 0xC2B2AE3DULL;
+    constexpr quint64 PRIME64_1 = 0x9E3779B185EBCA87ULL;
+    constexpr quint64 PRIME64_2 = 0xC2B2AE3D27D4EB4FULL;
+    constexpr quint64 PRIME64_3 = 0x165667B19E3779F9ULL;
+    constexpr quint64 PRIME64_4 = 0x85EBCA77C2B2AE63ULL;
+    constexpr quint64 PRIME64_5 = 0x27D4EB2F165667C5ULL;
+
+    constexpr int LANES = STRIPE_BYTES / 8;
+    // Stripe n of a block uses key words n..n+7; the scramble uses the last 8
+    constexpr int SECRET_WORDS = STRIPES_PER_BLOCK + LANES;
+    constexpr int SCRAMBLE_OFFSET = STRIPES_PER_BLOCK;
+    constexpr int MERGE_OFFSET_LOW = 3;
+    constexpr int MERGE_OFFSET_HIGH = 11;
+
+    constexpr std::array<quint64, SECRET_WORDS> makeSecret()
+    {
+        // splitmix64 sequence; any fixed high-entropy table works
+        std::array<quint64, SECRET_WORDS> secret{};
+        quint64 state = PRIME64_1;
+        for (int i = 0; i < SECRET_WORDS; ++i) {
+            state += 0x9E3779B97F4A7C15ULL;
+            quint64 z = state;
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+            secret[i] = z ^ (z >> 31);
+        }
+        return secret;
+    }
+
+    // Kept in memory in native order so the SIMD kernels can load it directly
+    alignas(32) constexpr std::array<quint64, SECRET_WORDS> SECRET = makeSecret();
+
+    // Little-endian load; memcpy keeps unaligned reads well-defined
+    inline quint64 read64(const unsigned char* p)
+    {
+        quint64 value;
+        std::memcpy(&value, p, sizeof(value));
+        return qFromLittleEndian(value);
+    }
+
+    inline quint64 multiplyFold(quint64 a, quint64 b)
+    {
+#if defined(__SIZEOF_INT128__)
+        const unsigned __int128 product = (unsigned __int128)a * b;
+        return quint64(product) ^ quint64(product >> 64);
+#elif defined(_MSC_VER) && defined(CONTENT_HASH_X86_64)
+        quint64 high;
+        const quint64 low = _umul128(a, b, &high);
+        return low ^ high;
+#else
+        const quint64 aLow = a & 0xFFFFFFFFULL;
+        const quint64 aHigh = a >> 32;
+        const quint64 bLow = b & 0xFFFFFFFFULL;
+        const quint64 bHigh = b >> 32;
+        const quint64 lowLow = aLow * bLow;
+        const quint64 highLow = aHigh * bLow;
+        const quint64 lowHigh = aLow * bHigh;
+        const quint64 highHigh = aHigh * bHigh;
+        const quint64 cross = (lowLow >> 32) + (highLow & 0xFFFFFFFFULL) + lowHigh;
+        const quint64 high = highHigh + (highLow >> 32) + (cross >> 32);
+        const quint64 low = (cross << 32) | (lowLow & 0xFFFFFFFFULL);
+        return low ^ high;
+#endif
+    }
+
+    inline quint64 avalanche(quint64 hash)
+    {
+        hash ^= hash >> 37;
+        hash *= 0x165667919E3779F9ULL;
+        return hash ^ (hash >> 32);
+    }
+
+    // Accumulation kernels. Each consumes `stripes` stripes starting at
+    // stripe `first` of the current block; for every lane the input word is
+    // added to the neighbouring lane and the product of the low and high
+    // halves of (input ^ key) to its own lane.
+    using AccumulateKernel = void (*)(quint64* acc, const unsigned char* input,
+                                      int first, int stripes);
+
+    void accumulateScalar(quint64* acc, const unsigned char* input, int first, int stripes)
+    {
+        for (int stripe = 0; stripe < stripes; ++stripe) {
+            const quint64* key = SECRET.data() + first + stripe;
+            const unsigned char* p = input + stripe * STRIPE_BYTES;
+            for (int lane = 0; lane < LANES; ++lane) {
+                const quint64 value = read64(p + lane * 8);
+                const quint64 keyed = value ^ key[lane];
+                acc[lane ^ 1] += value;
+                acc[lane] += (keyed & 0xFFFFFFFFULL) * (keyed >> 32);
+            }
+        }
+    }
+
+#if defined(CONTENT_HASH_X86_64) && Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+    // SSE2 is part of the x86-64 baseline, so this needs no run-time check
+    void accumulateSse2(quint64* acc, const unsigned char* input, int first, int stripes)
+    {
+        __m128i sums[LANES / 2];
+        for (int i = 0; i < LANES / 2; ++i) {
+            sums[i] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(acc) + i);
+        }
+        for (int stripe = 0; stripe < stripes; ++stripe) {
+            const auto* data = reinterpret_cast<const __m128i*>(input + stripe * STRIPE_BYTES);
+            const auto* key = reinterpret_cast<const __m128i*>(SECRET.data() + first + stripe);
+            for (int i = 0; i < LANES / 2; ++i) {
+                const __m128i value = _mm_loadu_si128(data + i);
+                const __m128i keyed = _mm_xor_si128(value, _mm_loadu_si128(key + i));
+                const __m128i keyedHigh = _mm_shuffle_epi32(keyed, _MM_SHUFFLE(0, 3, 0, 1));
+                const __m128i product = _mm_mul_epu32(keyed, keyedHigh);
+                const __m128i swapped = _mm_shuffle_epi32(value, _MM_SHUFFLE(1, 0, 3, 2));
+                sums[i] = _mm_add_epi64(sums[i], _mm_add_epi64(product, swapped));
+            }
+        }
+        for (int i = 0; i < LANES / 2; ++i) {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(acc) + i, sums[i]);
+        }
+    }
+
+    CONTENT_HASH_TARGET_AVX2
+    void accumulateAvx2(quint64* acc, const unsigned char* input, int first, int stripes)
+    {
+        __m256i sums[LANES / 4];
+        for (int i = 0; i < LANES / 4; ++i) {
+            sums[i] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(acc) + i);
+        }
+        for (int stripe = 0; stripe < stripes; ++stripe) {
+            const auto* data = reinterpret_cast<const __m256i*>(input + stripe * STRIPE_BYTES);
+            const auto* key = reinterpret_cast<const __m256i*>(SECRET.data() + first + stripe);
+            for (int i = 0; i < LANES / 4; ++i) {
+                const __m256i value = _mm256_loadu_si256(data + i);
+                const __m256i keyed = _mm256_xor_si256(value, _mm256_loadu_si256(key + i));
+                const __m256i keyedHigh = _mm256_shuffle_epi32(keyed, _MM_SHUFFLE(0, 3, 0, 1));
+                const __m256i product = _mm256_mul_epu32(keyed, keyedHigh);
+                const __m256i swapped = _mm256_shuffle_epi32(value, _MM_SHUFFLE(1, 0, 3, 2));
+                sums[i] = _mm256_add_epi64(sums[i], _mm256_add_epi64(product, swapped));
+            }
+        }
+        for (int i = 0; i < LANES / 4; ++i) {
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(acc) + i, sums[i]);
+        }
+    }
+
+    bool cpuHasAvx2()
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2");
+#elif defined(_MSC_VER)
+        int info[4];
+        __cpuid(info, 0);
+        if (info[0] < 7) {
+            return false;
+        }
+        __cpuid(info, 1);
+        const bool osSavesYmm = (info[2] & (1 << 27)) && (_xgetbv(0) & 0x6) == 0x6;
+        __cpuidex(info, 7, 0);
+        return osSavesYmm && (info[1] & (1 << 5));
+#else
+        return false;
+#endif
+    }
+#endif
+
+    struct Kernel {
+        AccumulateKernel accumulate;
+        const char* name;
+    };
+
+    const Kernel& kernel()
+    {
+        static const Kernel selected = []() -> Kernel {
+#if defined(CONTENT_HASH_X86_64) && Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+            if (cpuHasAvx2()) {
+                return {accumulateAvx2, "avx2"};
+            }
+            return {accumulateSse2, "sse2"};
+#else
+            return {accumulateScalar, "scalar"};
+#endif
+        }();
+        return selected;
+    }
+
+    void scramble(quint64* acc)
+    {
+        const quint64* key = SECRET.data() + SCRAMBLE_OFFSET;
+        for (int lane = 0; lane < LANES; ++lane) {
+            quint64 value = acc[lane];
+            value ^= value >> 47;
+            value ^= key[lane];
+            acc[lane] = value * PRIME32_1;
+        }
+    }
+
+    quint64 merge(const quint64* acc, int keyOffset, quint64 start)
+    {
+        const quint64* key = SECRET.data() + keyOffset;
+        quint64 hash = start;
+        for (int pair = 0; pair < LANES / 2; ++pair) {
+            hash += multiplyFold(acc[2 * pair] ^ key[2 * pair], acc[2 * pair + 1] ^ key[2 * pair + 1]);
+        }
+        return avalanche(hash);
+    }
+}
+
+ContentHasher::ContentHasher(quint64 seed)
+    : m_totalLength(0)
+    , m_bufferSize(0)
+    , m_stripesInBlock(0)
+{
+    const quint64 initial[LANES] = {
+        PRIME32_3, PRIME64_1, PRIME64_2, PRIME64_3,
+        PRIME64_4, PRIME32_2, PRIME64_5, PRIME32_1
+    };
+    for (int lane = 0; lane < LANES; ++lane) {
+        m_acc[lane] = (lane % 2 == 0) ? initial[lane] + seed : initial[lane] - seed;
+    }
+}
+
+void ContentHasher::consumeStripes(const unsigned char* input, qsizetype stripes)
+{
+    const AccumulateKernel accumulate = kernel().accumulate;
+    while (stripes > 0) {
+        const int run = int(qMin<qsizetype>(stripes, STRIPES_PER_BLOCK - m_stripesInBlock));
+        accumulate(m_acc, input, m_stripesInBlock, run);
+        input += qsizetype(run) * STRIPE_BYTES;
+        stripes -= run;
+        m_stripesInBlock += run;
+        if (m_stripesInBlock == STRIPES_PER_BLOCK) {
+            scramble(m_acc);
+            m_stripesInBlock = 0;
+        }
+    }
+}
+
+void ContentHasher::addData(const char* data, qsizetype length)
+{
+    if (length <= 0) {
+        return;
+    }
+
+    auto p = reinterpret_cast<const unsigned char*>(data);
+    const unsigned char* const end = p + length;
+    m_totalLength += quint64(length);
+
+    // Top up a partial stripe left over from the previous call
+    if (m_bufferSize > 0) {
+        const int needed = STRIPE_BYTES - m_bufferSize;
+        if (length < needed) {
+            std::memcpy(m_buffer + m_bufferSize, p, size_t(length));
+            m_bufferSize += int(length);
+            return;
+        }
+        std::memcpy(m_buffer + m_bufferSize, p, size_t(needed));
+        p += needed;
+        consumeStripes(m_buffer, 1);
+        m_bufferSize = 0;
+    }
+
+    const qsizetype stripes = (end - p) / STRIPE_BYTES;
+    if (stripes > 0) {
+        consumeStripes(p, stripes);
+        p += stripes * STRIPE_BYTES;
+    }
+
+    if (p < end) {
+        m_bufferSize = int(end - p);
+        std::memcpy(m_buffer, p, size_t(m_bufferSize));
+    }
+}
+
+void ContentHasher::finish(quint64* acc) const
+{
+    if (m_bufferSize == 0) {
+        return;
+    }
+
+    // The tail is zero-padded to a full stripe; the total length mixed in
+    // by the merge keeps padded and genuinely zero bytes apart
+    unsigned char last[STRIPE_BYTES] = {};
+    std::memcpy(last, m_buffer, size_t(m_bufferSize));
+    kernel().accumulate(acc, last, m_stripesInBlock, 1);
+}
+
+quint64 ContentHasher::result() const
+{
+    quint64 acc[LANES];
+    std::memcpy(acc, m_acc, sizeof(acc));
+    finish(acc);
+    return merge(acc, MERGE_OFFSET_LOW, m_totalLength * PRIME64_1);
+}
+
+ContentHash128 ContentHasher::result128() const
+{
+    quint64 acc[LANES];
+    std::memcpy(acc, m_acc, sizeof(acc));
+    finish(acc);
+
+    ContentHash128 hash;
+    hash.low = merge(acc, MERGE_OFFSET_LOW, m_totalLength * PRIME64_1);
+    hash.high = merge(acc, MERGE_OFFSET_HIGH, ~(m_totalLength * PRIME64_2));
+    return hash;
+}
+
+quint64 ContentHasher::hash(const char* data, qsizetype length, quint64 seed)
+{
+    ContentHasher hasher(seed);
+    hasher.addData(data, length);
+    return hasher.result();
+}
+
+ContentHash128 ContentHasher::hash128(const char* data, qsizetype length, quint64 seed)
+{
+    ContentHasher hasher(seed);
+    hasher.addData(data, length);
+    return hasher.result128();
+}
+
+quint64 ContentHasher::hashFile(const QString& filePath, qint64* size, bool* ok)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        if (ok) {
+            *ok = false;
+        }
+        return 0;
+    }
+    return hashDevice(&file, size, ok);
+}
+
+quint64 ContentHasher::hashDevice(QIODevice* device, qint64* size, bool* ok)
+{
+    ContentHasher hasher;
+    qint64 total = 0;
+    QByteArray chunk(FILE_CHUNK_SIZE, Qt::Uninitialized);
+    qint64 bytesRead;
+    while ((bytesRead = device->read(chunk.data(), FILE_CHUNK_SIZE)) > 0) {
+        hasher.addData(chunk.constData(), bytesRead);
+        total += bytesRead;
+    }
+
+    if (size) {
+        *size = total;
+    }
+    if (ok) {
+        *ok = bytesRead >= 0;
+    }
+    return hasher.result();
+}
+
+const char* ContentHasher::kernelName()
+{
+    return kernel().name;
+}
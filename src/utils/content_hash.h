@@ -0,0 +1,96 @@
+#ifndef CONTENT_HASH_H
+#define CONTENT_HASH_H
+
+#include <QByteArray>
+#include <QString>
+#include <QtGlobal>
+
+class QIODevice;
+
+// Configuration constants
+namespace ContentHashConfig {
+    // Bytes consumed per accumulation step, one 64-bit lane per 8 bytes
+    constexpr int STRIPE_BYTES = 64;
+    // Stripes accumulated before the accumulators are scrambled
+    constexpr int STRIPES_PER_BLOCK = 16;
+    // Read size when hashing a file that is not mapped
+    constexpr qint64 FILE_CHUNK_SIZE = 1024 * 1024;
+}
+
+/**
+ * @brief 128-bit content hash, for callers that cannot afford 64-bit collisions
+ */
+struct ContentHash128 {
+    quint64 low = 0;
+    quint64 high = 0;
+
+    bool operator==(const ContentHash128& other) const
+    {
+        return low == other.low && high == other.high;
+    }
+    bool operator!=(const ContentHash128& other) const { return !(*this == other); }
+};
+
+/**
+ * @brief Fast non-cryptographic content hash with 64- and 128-bit results
+ *
+ * Used to fingerprint baseline files and detect real content changes. The
+ * input is consumed in 64-byte stripes across eight independent 64-bit
+ * accumulators in the style of XXH3, which maps directly onto SSE2 and AVX2
+ * registers. The kernel is chosen once at run time from what the CPU
+ * supports; every kernel produces the same hash, so fingerprints stay
+ * comparable across machines. Not suitable for integrity or security
+ * purposes.
+ */
+class ContentHasher {
+public:
+    explicit ContentHasher(quint64 seed = 0);
+
+    /**
+     * @brief Feeds more data; may be called any number of times
+     */
+    void addData(const char* data, qsizetype length);
+    void addData(const QByteArray& data) { addData(data.constData(), data.size()); }
+
+    /**
+     * @brief Returns the hash of everything fed so far
+     */
+    quint64 result() const;
+    ContentHash128 result128() const;
+
+    /**
+     * @brief One-shot hash of a buffer
+     */
+    static quint64 hash(const char* data, qsizetype length, quint64 seed = 0);
+    static quint64 hash(const QByteArray& data) { return hash(data.constData(), data.size()); }
+    static ContentHash128 hash128(const char* data, qsizetype length, quint64 seed = 0);
+
+    /**
+     * @brief Hashes a file in chunks without loading it whole
+     * @param ok Set to false if the file could not be read
+     */
+    static quint64 hashFile(const QString& filePath, qint64* size = nullptr, bool* ok = nullptr);
+
+    /**
+     * @brief Hashes what is left to read from an open device, in chunks
+     */
+    static quint64 hashDevice(QIODevice* device, qint64* size = nullptr, bool* ok = nullptr);
+
+    /**
+     * @brief Name of the accumulation kernel in use ("avx2", "sse2" or "scalar")
+     */
+    static const char* kernelName();
+
+private:
+    void consumeStripes(const unsigned char* input, qsizetype stripes);
+    // Accumulates the buffered tail into acc, which starts as a copy of m_acc
+    void finish(quint64* acc) const;
+
+    quint64 m_acc[8];
+    quint64 m_totalLength;
+    unsigned char m_buffer[ContentHashConfig::STRIPE_BYTES];
+    int m_bufferSize;
+    int m_stripesInBlock;
+};
+
+#endif // CONTENT_HASH_H
@@ -1,9 +1,10 @@
 #include "helpers.h"
+#include "content_hash.h"
+#include "mapped_file.h"
 #include <QPixmap>
 #include <QByteArray>
 #include <QFile>
 #include <QTextStream>
-#include <QCryptographicHash>
 #include <QRegularExpression>
 #include <QStringConverter>
 
@@ -31,15 +32,10 @@ QString escapeMarkdownV2(const QString& text)
 
 QString readFileContent(const QString& filePath)
 {
-    QFile file(filePath);
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        return QString();
-    }
+    QString content = MappedFile::readText(filePath);
     
-    QTextStream stream(&file);
-    stream.setEncoding(QStringConverter::Utf8);
-    QString content = stream.readAll();
-    file.close();
+    // Match text-mode reading: line endings are normalized to '\n'
+    content.replace(QLatin1String("\r\n"), QLatin1String("\n"));
     
     return content;
 }
@@ -59,20 +55,15 @@ bool writeFileContent(const QString& filePath, const QString& content)
     return true;
 }
 
-QString calculateMd5Hash(const QString& filePath)
+QString calculateFileHash(const QString& filePath)
 {
-    QFile file(filePath);
-    if (!file.open(QIODevice::ReadOnly)) {
+    bool ok = false;
+    const quint64 hash = ContentHasher::hashFile(filePath, nullptr, &ok);
+    if (!ok) {
         return QString();
     }
     
-    QCryptographicHash hash(QCryptographicHash::Md5);
-    while (!file.atEnd()) {
-        hash.addData(file.read(8192));
-    }
-    file.close();
-    
-    return hash.result().toHex();
+    return QString::number(hash, 16).rightJustified(16, QLatin1Char('0'));
 }
 
 }
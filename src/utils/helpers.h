@@ -38,11 +38,11 @@ namespace Helpers {
     bool writeFileContent(const QString& filePath, const QString& content);
 
     /**
-     * @brief Calculates MD5 hash of a file
+     * @brief Calculates the content hash of a file
      * @param filePath Path to the file
-     * @return MD5 hash string
+     * @return ContentHasher hash as 16 hex digits, or empty string on error
      */
-    QString calculateMd5Hash(const QString& filePath);
+    QString calculateFileHash(const QString& filePath);
 }
 
 #endif // HELPERS_H
@@ -0,0 +1,288 @@
+#include "mapped_file.h"
+#include "content_hash.h"
+#include <cstring>
+
+#ifdef Q_OS_UNIX
+#include <csetjmp>
+#include <csignal>
+#endif
+
+namespace {
+    inline void setOk(bool* ok, bool value)
+    {
+        if (ok) {
+            *ok = value;
+        }
+    }
+
+#ifdef Q_OS_UNIX
+    // Where a fault in the guarded read running on this thread jumps to
+    thread_local sigjmp_buf* t_busJump = nullptr;
+    struct sigaction g_previousBusAction;
+
+    void onBusError(int signal, siginfo_t* info, void* context)
+    {
+        if (t_busJump) {
+            siglongjmp(*t_busJump, 1);
+        }
+
+        // Not a mapped read of ours: behave as if this handler were absent
+        if (g_previousBusAction.sa_flags & SA_SIGINFO) {
+            g_previousBusAction.sa_sigaction(signal, info, context);
+        } else if (g_previousBusAction.sa_handler != SIG_DFL && g_previousBusAction.sa_handler != SIG_IGN) {
+            g_previousBusAction.sa_handler(signal);
+        } else {
+            // The faulting access runs again on return and gets the default
+            struct sigaction defaultAction;
+            std::memset(&defaultAction, 0, sizeof(defaultAction));
+            defaultAction.sa_handler = SIG_DFL;
+            sigaction(SIGBUS, &defaultAction, nullptr);
+        }
+    }
+
+    void installBusHandler()
+    {
+        static const bool installed = [] {
+            struct sigaction action;
+            std::memset(&action, 0, sizeof(action));
+            action.sa_sigaction = onBusError;
+            sigemptyset(&action.sa_mask);
+            action.sa_flags = SA_SIGINFO;
+            return sigaction(SIGBUS, &action, &g_previousBusAction) == 0;
+        }();
+        Q_UNUSED(installed);
+    }
+#endif
+}
+
+MappedFile::MappedFile(const QString& filePath, qint64 maxReadBytes)
+    : m_file(filePath),
+      m_maxReadBytes(maxReadBytes)
+{
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        return;
+    }
+
+    const qint64 size = m_file.size();
+    if (size >= MappedFileConfig::MAP_MIN_BYTES) {
+        m_mapping = m_file.map(0, size);
+        if (m_mapping) {
+            m_size = size;
+            m_mode = Mode::Mapped;
+            return;
+        }
+    }
+
+    // Small files, and anything that cannot be mapped, are read instead
+    load();
+}
+
+MappedFile::~MappedFile()
+{
+    if (m_mapping) {
+        m_file.unmap(m_mapping);
+    }
+}
+
+void MappedFile::load()
+{
+    m_mode = Mode::Closed;
+    m_buffer = QByteArray();
+    if (m_file.pos() != 0 && !m_file.seek(0)) {
+        return;
+    }
+
+    const bool limited = m_maxReadBytes > 0;
+    if (limited && m_file.size() > m_maxReadBytes) {
+        m_size = m_file.size();
+        m_mode = Mode::Streamed;
+        return;
+    }
+
+    if (!m_file.isSequential()) {
+        m_buffer = m_file.readAll();
+    } else {
+        // A pipe reports no size, so read it in chunks up to the limit;
+        // what does not fit cannot be read a second time
+        QByteArray chunk(ContentHashConfig::FILE_CHUNK_SIZE, Qt::Uninitialized);
+        qint64 bytesRead;
+        while ((bytesRead = m_file.read(chunk.data(), chunk.size())) > 0) {
+            if (limited && m_buffer.size() + bytesRead > m_maxReadBytes) {
+                m_buffer = QByteArray();
+                return;
+            }
+            m_buffer.append(chunk.constData(), bytesRead);
+        }
+    }
+    if (m_file.error() != QFileDevice::NoError) {
+        m_buffer = QByteArray();
+        return;
+    }
+    m_size = m_buffer.size();
+    m_mode = Mode::Buffered;
+}
+
+void MappedFile::reload()
+{
+    m_file.unmap(m_mapping);
+    m_mapping = nullptr;
+    load();
+}
+
+template <typename Body>
+bool MappedFile::readMapped(Body body)
+{
+    // body must only read the mapping and write plain memory: a fault
+    // leaves it with siglongjmp, so it may not allocate or take locks
+    const char* data = reinterpret_cast<const char*>(m_mapping);
+#ifdef Q_OS_UNIX
+    installBusHandler();
+    sigjmp_buf jump;
+    sigjmp_buf* const outer = t_busJump;
+    if (sigsetjmp(jump, 1) != 0) {
+        // The file was truncated while mapped; read what is there now
+        t_busJump = outer;
+        reload();
+        return false;
+    }
+    t_busJump = &jump;
+    body(data, m_size);
+    t_busJump = outer;
+#else
+    body(data, m_size);
+#endif
+    return true;
+}
+
+quint64 MappedFile::hash(bool* ok)
+{
+    if (m_mode == Mode::Mapped) {
+        quint64 result = 0;
+        if (readMapped([&result](const char* data, qint64 size) {
+                result = ContentHasher::hash(data, size);
+            })) {
+            setOk(ok, true);
+            return result;
+        }
+    }
+
+    switch (m_mode) {
+        case Mode::Buffered:
+            setOk(ok, true);
+            return ContentHasher::hash(m_buffer);
+        case Mode::Streamed: {
+            if (m_file.pos() != 0 && !m_file.seek(0)) {
+                break;
+            }
+            bool read = false;
+            qint64 size = 0;
+            const quint64 result = ContentHasher::hashDevice(&m_file, &size, &read);
+            m_size = size;
+            setOk(ok, read);
+            return result;
+        }
+        default:
+            break;
+    }
+    setOk(ok, false);
+    return 0;
+}
+
+bool MappedFile::equals(const QByteArray& other, bool* ok)
+{
+    if (m_mode == Mode::Mapped) {
+        bool equal = false;
+        if (readMapped([&equal, &other](const char* data, qint64 size) {
+                equal = size == other.size() && std::memcmp(data, other.constData(), size_t(size)) == 0;
+            })) {
+            setOk(ok, true);
+            return equal;
+        }
+    }
+
+    switch (m_mode) {
+        case Mode::Buffered:
+            setOk(ok, true);
+            return m_buffer == other;
+        case Mode::Streamed: {
+            if (m_file.pos() != 0 && !m_file.seek(0)) {
+                break;
+            }
+            // Compare chunk by chunk without holding the file
+            QByteArray chunk(ContentHashConfig::FILE_CHUNK_SIZE, Qt::Uninitialized);
+            qint64 compared = 0;
+            qint64 bytesRead;
+            while ((bytesRead = m_file.read(chunk.data(), chunk.size())) > 0) {
+                if (compared + bytesRead > other.size() ||
+                    std::memcmp(chunk.constData(), other.constData() + compared, size_t(bytesRead)) != 0) {
+                    setOk(ok, true);
+                    return false;
+                }
+                compared += bytesRead;
+            }
+            setOk(ok, bytesRead == 0);
+            return bytesRead == 0 && compared == other.size();
+        }
+        default:
+            break;
+    }
+    setOk(ok, false);
+    return false;
+}
+
+QByteArray MappedFile::toByteArray(bool* ok)
+{
+    if (m_mode == Mode::Mapped) {
+        // Allocate before touching the mapping, see readMapped()
+        QByteArray copy(m_size, Qt::Uninitialized);
+        char* target = copy.data();
+        if (readMapped([target](const char* data, qint64 size) {
+                std::memcpy(target, data, size_t(size));
+            })) {
+            setOk(ok, true);
+            return copy;
+        }
+    }
+
+    if (m_mode == Mode::Buffered) {
+        setOk(ok, true);
+        return m_buffer;
+    }
+    setOk(ok, false);
+    return QByteArray();
+}
+
+quint64 MappedFile::fingerprint(qint64 maxContentBytes, QByteArray* content, bool* ok)
+{
+    if (content && hasBytes() && (maxContentBytes <= 0 || m_size <= maxContentBytes)) {
+        bool read = false;
+        const QByteArray bytes = toByteArray(&read);
+        if (read) {
+            // An empty file still has content, so never hand back a null array
+            *content = bytes.isNull() ? QByteArray("") : bytes;
+            setOk(ok, true);
+            return ContentHasher::hash(bytes);
+        }
+    }
+    if (content) {
+        *content = QByteArray();
+    }
+    return hash(ok);
+}
+
+QString MappedFile::toText()
+{
+    bool ok = false;
+    const QByteArray bytes = toByteArray(&ok);
+    if (!ok) {
+        return QString();
+    }
+    // An empty file is still readable, so never hand back a null string
+    return bytes.isEmpty() ? QString("") : QString::fromUtf8(bytes);
+}
+
+QString MappedFile::readText(const QString& filePath)
+{
+    MappedFile file(filePath, 0);
+    return file.toText();
+}
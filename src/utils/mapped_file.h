@@ -0,0 +1,125 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QString>
+
+// Configuration constants
+namespace MappedFileConfig {
+    // Below this a single read() is cheaper than setting up a mapping
+    constexpr qint64 MAP_MIN_BYTES = 64 * 1024;
+    // Default limit for reading a file that cannot be mapped into memory
+    constexpr qint64 MAX_READ_BYTES = 64 * 1024 * 1024;
+}
+
+/**
+ * @brief Read-only access to a whole file's bytes
+ *
+ * Large files are memory-mapped so hashing and comparing work straight on
+ * the page cache without copying; small files are read into one buffer.
+ * Files that cannot be mapped (pipes, FUSE, some network shares) are read
+ * into memory only up to maxReadBytes; larger ones are streamed in chunks
+ * by hash() and equals() and offer no bytes.
+ *
+ * Mapped bytes are only touched inside this class. On Unix a file that
+ * another process truncates while it is mapped raises SIGBUS on access;
+ * that fault is caught, and the file is read again privately as it is now,
+ * so size() may change after such a call. On Windows an open mapping
+ * blocks writers from truncating the file, so keep objects short-lived.
+ * Bytes are only decoded to QString by toText(), when text is actually
+ * needed for display.
+ */
+class MappedFile {
+public:
+    /**
+     * @param maxReadBytes Largest file read into memory when it cannot be
+     *        mapped; 0 or less means no limit
+     */
+    explicit MappedFile(const QString& filePath,
+                        qint64 maxReadBytes = MappedFileConfig::MAX_READ_BYTES);
+    ~MappedFile();
+
+    // Delete copy constructor and assignment operator
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool isOpen() const { return m_mode != Mode::Closed; }
+    qint64 size() const { return m_size; }
+
+    /**
+     * @brief Whether toByteArray() and toText() can return the content;
+     * false for a large unmappable file that is only streamed
+     */
+    bool hasBytes() const { return m_mode == Mode::Mapped || m_mode == Mode::Buffered; }
+
+    /**
+     * @brief ContentHasher hash of the bytes
+     * @param ok Set to false if the file could not be read
+     */
+    quint64 hash(bool* ok = nullptr);
+
+    /**
+     * @brief Whether the file holds exactly these bytes
+     */
+    bool equals(const QByteArray& other, bool* ok = nullptr);
+
+    /**
+     * @brief Owned copy of the bytes, shared with the read buffer if there is one
+     * @param ok Set to false if the file could not be read or has no bytes
+     */
+    QByteArray toByteArray(bool* ok = nullptr);
+
+    /**
+     * @brief Hashes the file, and copies its bytes if it is no larger than
+     * maxContentBytes (0 or less: any size)
+     *
+     * The hash is taken from the copy, so the two always agree even if the
+     * file changes meanwhile.
+     * @param content Receives the bytes; left null if they were not kept.
+     *        Pass nullptr to only hash.
+     * @param ok Set to false if the file could not be read
+     */
+    quint64 fingerprint(qint64 maxContentBytes, QByteArray* content, bool* ok = nullptr);
+
+    /**
+     * @brief Decodes the bytes as UTF-8
+     * @return Null QString if the file could not be read
+     */
+    QString toText();
+
+    /**
+     * @brief Reads a whole file as UTF-8 text, whatever its size
+     * @return Null QString if the file cannot be read
+     */
+    static QString readText(const QString& filePath);
+
+private:
+    enum class Mode {
+        Closed,
+        Mapped,
+        Buffered,
+        Streamed
+    };
+
+    // Reads the file from its start into m_buffer, or switches to
+    // streaming if it is above the limit
+    void load();
+
+    // Drops the mapping after a fault and falls back to load()
+    void reload();
+
+    // Runs body over the mapping; false if the mapped file was truncated
+    // underneath it, in which case the file has been reloaded
+    template <typename Body>
+    bool readMapped(Body body);
+
+    QFile m_file;
+    QByteArray m_buffer;
+    uchar* m_mapping = nullptr;
+    qint64 m_size = 0;
+    qint64 m_maxReadBytes = 0;
+    Mode m_mode = Mode::Closed;
+};
+
+#endif // MAPPED_FILE_H
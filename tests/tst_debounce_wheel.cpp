@@ -0,0 +1,205 @@
+#include "core/debounce_wheel.h"
+#include <QtTest>
+
+namespace {
+    constexpr qint64 QUIET_MS = 500;
+
+    QStringList pathsOf(const FileEventBatch& events)
+    {
+        QStringList paths;
+        for (const FileEvent& event : events) {
+            paths << event.path;
+        }
+        paths.sort();
+        return paths;
+    }
+}
+
+class TestDebounceWheel : public QObject {
+    Q_OBJECT
+
+private slots:
+    void firesAfterQuietPeriod();
+    void rescheduleDefers();
+    void rescheduleMergesKinds();
+    void maxDeferPeriods();
+    void wrapsAroundSlots();
+    void largeAdvanceJumps();
+    void renamePendingFile();
+    void renamePendingDirectory();
+    void removeDirectory();
+    void takeAll();
+};
+
+void TestDebounceWheel::firesAfterQuietPeriod()
+{
+    DebounceWheel wheel(QUIET_MS);
+    wheel.schedule("/r/a", FileEvent::Kind::Changed, 0);
+    QVERIFY(wheel.contains("/r/a"));
+
+    // Never early, and at most one tick late
+    QVERIFY(wheel.advance(QUIET_MS - 1).isEmpty());
+    const FileEventBatch fired = wheel.advance(QUIET_MS + wheel.tickInterval());
+    QCOMPARE(fired.size(), 1);
+    QCOMPARE(fired.first().path, QString("/r/a"));
+    QVERIFY(fired.first().kind == FileEvent::Kind::Changed);
+    QVERIFY(wheel.isEmpty());
+}
+
+void TestDebounceWheel::rescheduleDefers()
+{
+    DebounceWheel wheel(QUIET_MS);
+    wheel.schedule("/r/a", FileEvent::Kind::Changed, 0);
+    wheel.schedule("/r/a", FileEvent::Kind::Changed, 300);
+    QCOMPARE(wheel.size(), 1);
+
+    // The first deadline passed, but the path was written again meanwhile
+    QVERIFY(wheel.advance(300 + QUIET_MS - 1).isEmpty());
+    QCOMPARE(wheel.advance(300 + QUIET_MS + wheel.tickInterval()).size(), 1);
+    QVERIFY(wheel.isEmpty());
+}
+
+void TestDebounceWheel::rescheduleMergesKinds()
+{
+    DebounceWheel wheel(QUIET_MS);
+    wheel.schedule("/r/created", FileEvent::Kind::Created, 0);
+    wheel.schedule("/r/created", FileEvent::Kind::Changed, 10);
+    wheel.schedule("/r/replaced", FileEvent::Kind::Deleted, 0);
+    wheel.schedule("/r/replaced", FileEvent::Kind::Created, 10);
+    wheel.schedule("/r/deleted", FileEvent::Kind::Changed, 0);
+    wheel.schedule("/r/deleted", FileEvent::Kind::Deleted, 10);
+
+    const FileEventBatch fired = wheel.advance(10 + QUIET_MS + wheel.tickInterval());
+    QCOMPARE(fired.size(), 3);
+    for (const FileEvent& event : fired) {
+        if (event.path == "/r/created") {
+            QVERIFY(event.kind == FileEvent::Kind::Created);
+        } else if (event.path == "/r/replaced") {
+            QVERIFY(event.kind == FileEvent::Kind::Changed);
+        } else {
+            QVERIFY(event.kind == FileEvent::Kind::Deleted);
+        }
+    }
+}
+
+void TestDebounceWheel::maxDeferPeriods()
+{
+    // A path written without pause still fires after MAX_DEFER_PERIODS
+    DebounceWheel wheel(QUIET_MS);
+    const qint64 latestMs = DebounceConfig::MAX_DEFER_PERIODS * QUIET_MS;
+    for (qint64 now = 0; now < latestMs; now += 100) {
+        wheel.schedule("/r/log", FileEvent::Kind::Changed, now);
+        QVERIFY(wheel.advance(now).isEmpty());
+    }
+    QVERIFY(wheel.advance(latestMs - 1).isEmpty());
+    QCOMPARE(wheel.advance(latestMs + wheel.tickInterval()).size(), 1);
+}
+
+void TestDebounceWheel::wrapsAroundSlots()
+{
+    DebounceWheel wheel(QUIET_MS);
+    const qint64 turnMs = DebounceConfig::WHEEL_SLOTS * wheel.tickInterval();
+
+    // Deadlines late in one turn and early in the next, advanced in small steps
+    for (int round = 0; round < 3; ++round) {
+        const qint64 start = round * turnMs + turnMs / 2;
+        wheel.schedule("/r/a", FileEvent::Kind::Changed, start);
+        wheel.schedule("/r/b", FileEvent::Kind::Changed, start + QUIET_MS / 2);
+
+        QStringList fired;
+        for (qint64 now = start; now <= start + 2 * QUIET_MS; now += wheel.tickInterval()) {
+            const FileEventBatch batch = wheel.advance(now);
+            for (const FileEvent& event : batch) {
+                QVERIFY(now >= (event.path == "/r/a" ? start : start + QUIET_MS / 2) + QUIET_MS);
+                fired << event.path;
+            }
+        }
+        QCOMPARE(fired, QStringList({"/r/a", "/r/b"}));
+        QVERIFY(wheel.isEmpty());
+    }
+}
+
+void TestDebounceWheel::largeAdvanceJumps()
+{
+    DebounceWheel wheel(QUIET_MS);
+    const qint64 turnMs = DebounceConfig::WHEEL_SLOTS * wheel.tickInterval();
+
+    // Nothing advanced the wheel for several turns while events came in
+    wheel.schedule("/r/early", FileEvent::Kind::Changed, 0);
+    wheel.schedule("/r/late", FileEvent::Kind::Changed, 5 * turnMs);
+
+    // One visit per slot fires what is due and keeps what is not
+    const FileEventBatch first = wheel.advance(5 * turnMs);
+    QCOMPARE(pathsOf(first), QStringList({"/r/early"}));
+    QVERIFY(wheel.contains("/r/late"));
+
+    QVERIFY(wheel.advance(5 * turnMs + QUIET_MS - 1).isEmpty());
+    const FileEventBatch second = wheel.advance(5 * turnMs + QUIET_MS + wheel.tickInterval());
+    QCOMPARE(pathsOf(second), QStringList({"/r/late"}));
+
+    // Both due long ago: a single jump fires them together
+    wheel.schedule("/r/x", FileEvent::Kind::Changed, 10 * turnMs);
+    wheel.schedule("/r/y", FileEvent::Kind::Created, 10 * turnMs + 100);
+    QCOMPARE(pathsOf(wheel.advance(50 * turnMs)), QStringList({"/r/x", "/r/y"}));
+    QVERIFY(wheel.isEmpty());
+}
+
+void TestDebounceWheel::renamePendingFile()
+{
+    DebounceWheel wheel(QUIET_MS);
+    wheel.schedule("/r/a", FileEvent::Kind::Created, 0);
+    wheel.rename("/r/a", "/r/b", false, 300);
+    QVERIFY(!wheel.contains("/r/a"));
+    QVERIFY(wheel.contains("/r/b"));
+
+    // Re-armed from the rename; the old slot reference is stale
+    QVERIFY(wheel.advance(300 + QUIET_MS - 1).isEmpty());
+    const FileEventBatch fired = wheel.advance(300 + QUIET_MS + wheel.tickInterval());
+    QCOMPARE(fired.size(), 1);
+    QCOMPARE(fired.first().path, QString("/r/b"));
+    QVERIFY(fired.first().kind == FileEvent::Kind::Created);
+}
+
+void TestDebounceWheel::renamePendingDirectory()
+{
+    DebounceWheel wheel(QUIET_MS);
+    wheel.schedule("/r/d/x", FileEvent::Kind::Changed, 0);
+    wheel.schedule("/r/d/sub/y", FileEvent::Kind::Changed, 0);
+    wheel.schedule("/r/dx", FileEvent::Kind::Changed, 0);
+    wheel.rename("/r/d", "/r/e", true, 0);
+
+    QVERIFY(wheel.contains("/r/e/x"));
+    QVERIFY(wheel.contains("/r/e/sub/y"));
+    // Only paths below the directory move, not siblings sharing its prefix
+    QVERIFY(wheel.contains("/r/dx"));
+    QCOMPARE(wheel.size(), 3);
+
+    QCOMPARE(pathsOf(wheel.advance(QUIET_MS + wheel.tickInterval())),
+             QStringList({"/r/dx", "/r/e/sub/y", "/r/e/x"}));
+}
+
+void TestDebounceWheel::removeDirectory()
+{
+    DebounceWheel wheel(QUIET_MS);
+    wheel.schedule("/r/d/x", FileEvent::Kind::Changed, 0);
+    wheel.schedule("/r/d/sub/y", FileEvent::Kind::Created, 0);
+    wheel.schedule("/r/dx", FileEvent::Kind::Changed, 0);
+    wheel.removeDirectory("/r/d");
+
+    QCOMPARE(wheel.size(), 1);
+    QCOMPARE(pathsOf(wheel.advance(QUIET_MS + wheel.tickInterval())), QStringList({"/r/dx"}));
+}
+
+void TestDebounceWheel::takeAll()
+{
+    DebounceWheel wheel(QUIET_MS);
+    wheel.schedule("/r/a", FileEvent::Kind::Changed, 0);
+    wheel.schedule("/r/b", FileEvent::Kind::Deleted, 100);
+
+    QCOMPARE(pathsOf(wheel.takeAll()), QStringList({"/r/a", "/r/b"}));
+    QVERIFY(wheel.isEmpty());
+    QVERIFY(wheel.advance(10 * QUIET_MS).isEmpty());
+}
+
+QTEST_APPLESS_MAIN(TestDebounceWheel)
+#include "tst_debounce_wheel.moc"
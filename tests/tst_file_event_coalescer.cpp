@@ -0,0 +1,166 @@
+#include "core/file_event.h"
+#include <QtTest>
+
+class TestFileEventCoalescer : public QObject {
+    Q_OBJECT
+
+private slots:
+    void mergeTable_data();
+    void mergeTable();
+    void keepsFirstSeenOrder();
+    void renameCarriesPendingFile();
+    void renameCarriesPendingDirectory();
+    void eventsAfterRenameFollowIt();
+    void directoryRemovalDropsPending();
+    void takeStartsNewWindow();
+};
+
+void TestFileEventCoalescer::mergeTable_data()
+{
+    QTest::addColumn<int>("pending");
+    QTest::addColumn<int>("incoming");
+    QTest::addColumn<int>("expected");
+
+    const int changed = int(FileEvent::Kind::Changed);
+    const int created = int(FileEvent::Kind::Created);
+    const int deleted = int(FileEvent::Kind::Deleted);
+
+    QTest::newRow("changed, changed") << changed << changed << changed;
+    QTest::newRow("changed, created") << changed << created << changed;
+    QTest::newRow("changed, deleted") << changed << deleted << deleted;
+    QTest::newRow("created, changed") << created << changed << created;
+    QTest::newRow("created, created") << created << created << created;
+    QTest::newRow("created, deleted") << created << deleted << deleted;
+    QTest::newRow("deleted, changed") << deleted << changed << changed;
+    QTest::newRow("deleted, created") << deleted << created << changed;
+    QTest::newRow("deleted, deleted") << deleted << deleted << deleted;
+}
+
+void TestFileEventCoalescer::mergeTable()
+{
+    QFETCH(int, pending);
+    QFETCH(int, incoming);
+    QFETCH(int, expected);
+
+    QVERIFY(FileEvent::merge(FileEvent::Kind(pending), FileEvent::Kind(incoming)) == FileEvent::Kind(expected));
+
+    FileEventCoalescer coalescer;
+    coalescer.add("/r/a", FileEvent::Kind(pending));
+    coalescer.add("/r/a", FileEvent::Kind(incoming));
+    QCOMPARE(coalescer.size(), 1);
+    QCOMPARE(coalescer.mergedCount(), 1);
+
+    const FileEventBatch events = coalescer.take();
+    QCOMPARE(events.size(), 1);
+    QVERIFY(events.first().kind == FileEvent::Kind(expected));
+}
+
+void TestFileEventCoalescer::keepsFirstSeenOrder()
+{
+    FileEventCoalescer coalescer;
+    coalescer.add("/r/b", FileEvent::Kind::Changed);
+    coalescer.add("/r/a", FileEvent::Kind::Created);
+    coalescer.add("/r/b", FileEvent::Kind::Changed);
+    coalescer.add("/r/c", FileEvent::Kind::Deleted);
+    coalescer.add("/r/a", FileEvent::Kind::Changed);
+    QCOMPARE(coalescer.mergedCount(), 2);
+
+    const FileEventBatch events = coalescer.take();
+    QCOMPARE(events.size(), 3);
+    QCOMPARE(events.at(0).path, QString("/r/b"));
+    QCOMPARE(events.at(1).path, QString("/r/a"));
+    QVERIFY(events.at(1).kind == FileEvent::Kind::Created);
+    QCOMPARE(events.at(2).path, QString("/r/c"));
+}
+
+void TestFileEventCoalescer::renameCarriesPendingFile()
+{
+    FileEventCoalescer coalescer;
+    coalescer.add("/r/a", FileEvent::Kind::Created);
+    coalescer.addRename("/r/a", "/r/b", false);
+
+    const FileEventBatch events = coalescer.take();
+    QCOMPARE(events.size(), 2);
+    QVERIFY(events.at(0).kind == FileEvent::Kind::Renamed);
+    QCOMPARE(events.at(0).oldPath, QString("/r/a"));
+    QCOMPARE(events.at(0).path, QString("/r/b"));
+    QVERIFY(!events.at(0).isDirectory);
+    // The pending event follows the file and is reported after the rename
+    QCOMPARE(events.at(1).path, QString("/r/b"));
+    QVERIFY(events.at(1).kind == FileEvent::Kind::Created);
+}
+
+void TestFileEventCoalescer::renameCarriesPendingDirectory()
+{
+    FileEventCoalescer coalescer;
+    coalescer.add("/r/d/x", FileEvent::Kind::Changed);
+    coalescer.add("/r/dx", FileEvent::Kind::Changed);
+    coalescer.add("/r/d/sub/y", FileEvent::Kind::Deleted);
+    coalescer.addRename("/r/d", "/r/e", true);
+
+    const FileEventBatch events = coalescer.take();
+    QCOMPARE(events.size(), 4);
+    // A sibling sharing the directory's prefix stays where it was
+    QCOMPARE(events.at(0).path, QString("/r/dx"));
+    QVERIFY(events.at(1).kind == FileEvent::Kind::Renamed);
+    QVERIFY(events.at(1).isDirectory);
+    QCOMPARE(events.at(1).oldPath, QString("/r/d"));
+    QCOMPARE(events.at(1).path, QString("/r/e"));
+
+    QStringList carried{events.at(2).path, events.at(3).path};
+    carried.sort();
+    QCOMPARE(carried, QStringList({"/r/e/sub/y", "/r/e/x"}));
+}
+
+void TestFileEventCoalescer::eventsAfterRenameFollowIt()
+{
+    // Something was pending for the target before another file replaced it
+    FileEventCoalescer coalescer;
+    coalescer.add("/r/b", FileEvent::Kind::Deleted);
+    coalescer.addRename("/r/a", "/r/b", false);
+    coalescer.add("/r/b", FileEvent::Kind::Changed);
+
+    const FileEventBatch events = coalescer.take();
+    QCOMPARE(events.size(), 3);
+    QVERIFY(events.at(0).kind == FileEvent::Kind::Deleted);
+    QVERIFY(events.at(1).kind == FileEvent::Kind::Renamed);
+    QCOMPARE(events.at(2).path, QString("/r/b"));
+    QVERIFY(events.at(2).kind == FileEvent::Kind::Changed);
+}
+
+void TestFileEventCoalescer::directoryRemovalDropsPending()
+{
+    FileEventCoalescer coalescer;
+    coalescer.add("/r/d/x", FileEvent::Kind::Changed);
+    coalescer.add("/r/dx", FileEvent::Kind::Created);
+    coalescer.add("/r/d/sub/y", FileEvent::Kind::Created);
+    coalescer.addDirectoryRemoval("/r/d");
+    QCOMPARE(coalescer.mergedCount(), 2);
+
+    const FileEventBatch events = coalescer.take();
+    QCOMPARE(events.size(), 2);
+    QCOMPARE(events.at(0).path, QString("/r/dx"));
+    QCOMPARE(events.at(1).path, QString("/r/d"));
+    QVERIFY(events.at(1).kind == FileEvent::Kind::Deleted);
+    QVERIFY(events.at(1).isDirectory);
+}
+
+void TestFileEventCoalescer::takeStartsNewWindow()
+{
+    FileEventCoalescer coalescer;
+    coalescer.add("/r/a", FileEvent::Kind::Changed);
+    coalescer.add("/r/a", FileEvent::Kind::Changed);
+    QCOMPARE(coalescer.take().size(), 1);
+
+    QVERIFY(coalescer.isEmpty());
+    QCOMPARE(coalescer.mergedCount(), 0);
+
+    // The path is new to the next window and no longer merges
+    coalescer.add("/r/a", FileEvent::Kind::Created);
+    const FileEventBatch events = coalescer.take();
+    QCOMPARE(events.size(), 1);
+    QVERIFY(events.first().kind == FileEvent::Kind::Created);
+}
+
+QTEST_APPLESS_MAIN(TestFileEventCoalescer)
+#include "tst_file_event_coalescer.moc"
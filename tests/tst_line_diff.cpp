@@ -0,0 +1,276 @@
+#include "core/line_diff.h"
+#include <QString>
+#include <QStringList>
+#include <QtTest>
+
+namespace {
+    const QVector<LineDiff::Algorithm> ALGORITHMS = {
+        LineDiff::Algorithm::Myers,
+        LineDiff::Algorithm::Histogram
+    };
+
+    // Rebuilds the new text from the old one and the hunks, checking on the
+    // way that the hunks are ordered and that the lines between them match
+    QString applyHunks(const QString& oldText, const QString& newText,
+                       const QVector<DiffHunk>& hunks, bool* ok)
+    {
+        *ok = false;
+        const QStringList oldLines = oldText.split(QLatin1Char('\n'));
+        const QStringList newLines = newText.split(QLatin1Char('\n'));
+
+        QStringList result;
+        int oldIndex = 0;
+        int newIndex = 0;
+        for (const DiffHunk& hunk : hunks) {
+            if (hunk.oldStart < oldIndex || hunk.newStart < newIndex
+                || hunk.oldStart - oldIndex != hunk.newStart - newIndex
+                || hunk.oldStart + hunk.oldCount > oldLines.size()
+                || hunk.newStart + hunk.newCount > newLines.size()) {
+                return QString();
+            }
+            while (oldIndex < hunk.oldStart) {
+                if (oldLines.at(oldIndex) != newLines.at(newIndex)) {
+                    return QString();
+                }
+                result << oldLines.at(oldIndex++);
+                ++newIndex;
+            }
+            result << newLines.mid(hunk.newStart, hunk.newCount);
+            oldIndex += hunk.oldCount;
+            newIndex += hunk.newCount;
+        }
+
+        if (oldLines.size() - oldIndex != newLines.size() - newIndex) {
+            return QString();
+        }
+        while (oldIndex < oldLines.size()) {
+            if (oldLines.at(oldIndex) != newLines.at(newIndex)) {
+                return QString();
+            }
+            result << oldLines.at(oldIndex++);
+            ++newIndex;
+        }
+
+        *ok = true;
+        return result.join(QLatin1Char('\n'));
+    }
+
+    int changedOldLines(const QVector<DiffHunk>& hunks)
+    {
+        int count = 0;
+        for (const DiffHunk& hunk : hunks) {
+            count += hunk.oldCount;
+        }
+        return count;
+    }
+
+    int changedNewLines(const QVector<DiffHunk>& hunks)
+    {
+        int count = 0;
+        for (const DiffHunk& hunk : hunks) {
+            count += hunk.newCount;
+        }
+        return count;
+    }
+}
+
+class TestLineDiff : public QObject {
+    Q_OBJECT
+
+private slots:
+    void equalTexts();
+    void roundTrip_data();
+    void roundTrip();
+    void insertOnly();
+    void deleteOnly();
+    void trailingNewline();
+    void movedBlock();
+    void cancelled();
+    void editDistanceFallback();
+    void commonLines_data();
+    void commonLines();
+};
+
+void TestLineDiff::equalTexts()
+{
+    for (LineDiff::Algorithm algorithm : ALGORITHMS) {
+        QVERIFY(LineDiff::compute(u"", u"", algorithm).isEmpty());
+        QVERIFY(LineDiff::compute(u"a\nb\nc", u"a\nb\nc", algorithm).isEmpty());
+    }
+}
+
+void TestLineDiff::roundTrip_data()
+{
+    QTest::addColumn<QString>("oldText");
+    QTest::addColumn<QString>("newText");
+
+    QTest::newRow("empty to text") << QString("") << QString("a\nb");
+    QTest::newRow("text to empty") << QString("a\nb") << QString("");
+    QTest::newRow("single line") << QString("a") << QString("b");
+    QTest::newRow("middle line") << QString("a\nb\nc") << QString("a\nX\nc");
+    QTest::newRow("partial line") << QString("abc\nx") << QString("abd\nx");
+    QTest::newRow("repeated lines") << QString("a\na\nb\na\na") << QString("a\nb\na\nb\na");
+    QTest::newRow("blank lines") << QString("\n\nx\n\n") << QString("\nx\n\n\ny\n");
+    QTest::newRow("all different") << QString("a\nb\nc") << QString("d\ne");
+}
+
+void TestLineDiff::roundTrip()
+{
+    QFETCH(QString, oldText);
+    QFETCH(QString, newText);
+
+    for (LineDiff::Algorithm algorithm : ALGORITHMS) {
+        const QVector<DiffHunk> hunks = LineDiff::compute(oldText, newText, algorithm);
+        QVERIFY(!hunks.isEmpty());
+        bool ok = false;
+        QCOMPARE(applyHunks(oldText, newText, hunks, &ok), newText);
+        QVERIFY(ok);
+    }
+}
+
+void TestLineDiff::insertOnly()
+{
+    const QString oldText = "a\nc\ne";
+    const QString newText = "a\nb\nc\nd\ne";
+    for (LineDiff::Algorithm algorithm : ALGORITHMS) {
+        const QVector<DiffHunk> hunks = LineDiff::compute(oldText, newText, algorithm);
+        QCOMPARE(hunks.size(), 2);
+        QCOMPARE(changedOldLines(hunks), 0);
+        QCOMPARE(changedNewLines(hunks), 2);
+        bool ok = false;
+        QCOMPARE(applyHunks(oldText, newText, hunks, &ok), newText);
+        QVERIFY(ok);
+    }
+}
+
+void TestLineDiff::deleteOnly()
+{
+    const QString oldText = "a\nb\nc\nd\ne";
+    const QString newText = "a\nc\ne";
+    for (LineDiff::Algorithm algorithm : ALGORITHMS) {
+        const QVector<DiffHunk> hunks = LineDiff::compute(oldText, newText, algorithm);
+        QCOMPARE(hunks.size(), 2);
+        QCOMPARE(changedOldLines(hunks), 2);
+        QCOMPARE(changedNewLines(hunks), 0);
+        bool ok = false;
+        QCOMPARE(applyHunks(oldText, newText, hunks, &ok), newText);
+        QVERIFY(ok);
+    }
+}
+
+void TestLineDiff::trailingNewline()
+{
+    // A trailing newline adds an empty last line, as QString::split() does
+    for (LineDiff::Algorithm algorithm : ALGORITHMS) {
+        const QVector<DiffHunk> added = LineDiff::compute(u"a\nb", u"a\nb\n", algorithm);
+        QCOMPARE(added.size(), 1);
+        QCOMPARE(added.first().oldStart, 2);
+        QCOMPARE(added.first().oldCount, 0);
+        QCOMPARE(added.first().newStart, 2);
+        QCOMPARE(added.first().newCount, 1);
+
+        const QVector<DiffHunk> removed = LineDiff::compute(u"a\nb\n", u"a\nb", algorithm);
+        QCOMPARE(removed.size(), 1);
+        QCOMPARE(removed.first().oldStart, 2);
+        QCOMPARE(removed.first().oldCount, 1);
+        QCOMPARE(removed.first().newCount, 0);
+    }
+}
+
+void TestLineDiff::movedBlock()
+{
+    // Swapping a short and a long block: only the short one should move
+    const QString shortBlock = "s1\ns2\ns3";
+    const QString longBlock = "l1\nl2\nl3\nl4\nl5";
+    const QString oldText = shortBlock + "\n" + longBlock;
+    const QString newText = longBlock + "\n" + shortBlock;
+
+    for (LineDiff::Algorithm algorithm : ALGORITHMS) {
+        const QVector<DiffHunk> hunks = LineDiff::compute(oldText, newText, algorithm);
+        QCOMPARE(changedOldLines(hunks), 3);
+        QCOMPARE(changedNewLines(hunks), 3);
+        bool ok = false;
+        QCOMPARE(applyHunks(oldText, newText, hunks, &ok), newText);
+        QVERIFY(ok);
+    }
+}
+
+void TestLineDiff::cancelled()
+{
+    const std::atomic<bool> cancelled(true);
+    for (LineDiff::Algorithm algorithm : ALGORITHMS) {
+        QVERIFY(LineDiff::compute(u"a\nb\nc", u"a\nX\nc", algorithm, &cancelled).isEmpty());
+    }
+}
+
+void TestLineDiff::editDistanceFallback()
+{
+    // Every other line differs, so a minimal script needs one edit per
+    // line; the search needs about half of that from each end, which is
+    // more than MAX_EDIT_DISTANCE allows
+    const int lineCount = 2 * DiffConfig::MAX_EDIT_DISTANCE + 2000;
+    QVector<quint32> oldIds;
+    QVector<quint32> newIds;
+    for (int i = 0; i < lineCount; ++i) {
+        oldIds.append(quint32(i));
+        newIds.append(quint32(i % 2 == 0 ? i : lineCount + i));
+    }
+
+    const QVector<DiffHunk> hunks = LineDiff::compute(oldIds, newIds, 2 * lineCount,
+                                                      LineDiff::Algorithm::Myers);
+    // Past the shared first line the rest is reported as replaced as a whole
+    QCOMPARE(hunks.size(), 1);
+    QCOMPARE(hunks.first().oldStart, 1);
+    QCOMPARE(hunks.first().oldCount, lineCount - 1);
+    QCOMPARE(hunks.first().newStart, 1);
+    QCOMPARE(hunks.first().newCount, lineCount - 1);
+
+    // Below the limit the same pattern is diffed line by line
+    const int shortCount = 200;
+    const QVector<DiffHunk> fine = LineDiff::compute(oldIds.mid(0, shortCount), newIds.mid(0, shortCount),
+                                                     2 * lineCount, LineDiff::Algorithm::Myers);
+    QCOMPARE(fine.size(), shortCount / 2);
+    QCOMPARE(changedOldLines(fine), shortCount / 2);
+    QCOMPARE(changedNewLines(fine), shortCount / 2);
+}
+
+void TestLineDiff::commonLines_data()
+{
+    QTest::addColumn<QString>("oldText");
+    QTest::addColumn<QString>("newText");
+    QTest::addColumn<int>("prefixLines");
+    QTest::addColumn<int>("suffixLines");
+
+    QTest::newRow("equal") << QString("a\nb\nc") << QString("a\nb\nc") << 3 << 0;
+    QTest::newRow("both empty") << QString("") << QString("") << 1 << 0;
+    QTest::newRow("empty old") << QString("") << QString("a") << 0 << 0;
+    QTest::newRow("middle line") << QString("a\nb\nc") << QString("a\nX\nc") << 1 << 1;
+    QTest::newRow("last line") << QString("a\nb") << QString("a\nc") << 1 << 0;
+    QTest::newRow("first line") << QString("a\nb") << QString("X\nb") << 0 << 1;
+    QTest::newRow("partial line") << QString("abc\nx") << QString("abd\nx") << 0 << 1;
+    // The shared lines could count as prefix or suffix, never as both
+    QTest::newRow("overlap") << QString("a\na") << QString("a\na\na") << 1 << 0;
+}
+
+void TestLineDiff::commonLines()
+{
+    QFETCH(QString, oldText);
+    QFETCH(QString, newText);
+    QFETCH(int, prefixLines);
+    QFETCH(int, suffixLines);
+
+    int prefix = -1;
+    int suffix = -1;
+    LineDiff::commonLines(oldText, newText, &prefix, &suffix);
+    QCOMPARE(prefix, prefixLines);
+    QCOMPARE(suffix, suffixLines);
+
+    if (oldText != newText) {
+        // At least one line of each text lies between the two runs
+        QVERIFY(prefix + suffix < int(oldText.count(QLatin1Char('\n'))) + 1);
+        QVERIFY(prefix + suffix < int(newText.count(QLatin1Char('\n'))) + 1);
+    }
+}
+
+QTEST_APPLESS_MAIN(TestLineDiff)
+#include "tst_line_diff.moc"
@@ -0,0 +1,249 @@
+#include "core/file_manifest.h"
+#include "services/polling_scanner.h"
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QTemporaryDir>
+#include <QThreadPool>
+#include <QtTest>
+
+namespace {
+    // Whole seconds, so the stamps survive file systems with coarse mtimes
+    const QDateTime FIRST_MTIME = QDateTime::fromSecsSinceEpoch(1700000000);
+    const QDateTime SECOND_MTIME = QDateTime::fromSecsSinceEpoch(1700000100);
+
+    bool writeFile(const QString& path, const QByteArray& content, const QDateTime& mtime = FIRST_MTIME)
+    {
+        QFile file(path);
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            return false;
+        }
+        // Flushed first, or closing would move the mtime again
+        return file.write(content) == content.size() && file.flush()
+            && file.setFileTime(mtime, QFileDevice::FileModificationTime);
+    }
+}
+
+class TestPollingScanner : public QObject {
+    Q_OBJECT
+
+private slots:
+    void init();
+    void firstScanBuildsIndex();
+    void classifiesStamp_data();
+    void classifiesStamp();
+    void reportsInEventOrder();
+    void renamePairedByInode();
+    void renameWithChangedStampNotPaired();
+    void newDirectory();
+    void removedDirectory();
+    void excludedPathsIgnored();
+    void seedReportsChangesSinceManifest();
+
+private:
+    QString path(const QString& relativePath) const { return m_dir->path() + "/" + relativePath; }
+    FileEventBatch scan(PollingScanner* scanner) { return scanner->scan(&m_pool); }
+
+    QScopedPointer<QTemporaryDir> m_dir;
+    QThreadPool m_pool;
+};
+
+void TestPollingScanner::init()
+{
+    m_dir.reset(new QTemporaryDir());
+    QVERIFY(m_dir->isValid());
+    QVERIFY(QDir(m_dir->path()).mkdir("sub"));
+    QVERIFY(writeFile(path("a.txt"), "alpha"));
+    QVERIFY(writeFile(path("sub/b.txt"), "beta"));
+}
+
+void TestPollingScanner::firstScanBuildsIndex()
+{
+    PollingScanner scanner(m_dir->path(), ExclusionMatcher());
+    QVERIFY(scan(&scanner).isEmpty());
+    QCOMPARE(scanner.fileCount(), 2);
+    QCOMPARE(scanner.directoryCount(), 2);
+
+    // Nothing changed since
+    QVERIFY(scan(&scanner).isEmpty());
+    QCOMPARE(scanner.fileCount(), 2);
+}
+
+void TestPollingScanner::classifiesStamp_data()
+{
+    QTest::addColumn<QString>("change");
+    QTest::addColumn<bool>("expectChanged");
+
+    QTest::newRow("untouched") << QString("none") << false;
+    QTest::newRow("rewritten unchanged") << QString("same") << false;
+    QTest::newRow("size only") << QString("size") << true;
+    QTest::newRow("mtime only") << QString("mtime") << true;
+    QTest::newRow("inode only") << QString("inode") << true;
+}
+
+void TestPollingScanner::classifiesStamp()
+{
+    QFETCH(QString, change);
+    QFETCH(bool, expectChanged);
+
+    PollingScanner scanner(m_dir->path(), ExclusionMatcher());
+    QVERIFY(scan(&scanner).isEmpty());
+
+    if (change == "same") {
+        QVERIFY(writeFile(path("a.txt"), "alpha"));
+    } else if (change == "size") {
+        QVERIFY(writeFile(path("a.txt"), "alphabet"));
+    } else if (change == "mtime") {
+        QVERIFY(writeFile(path("a.txt"), "ALPHA", SECOND_MTIME));
+    } else if (change == "inode") {
+#ifndef Q_OS_UNIX
+        QSKIP("Inode numbers are only tracked on Unix");
+#endif
+        // Same size and mtime, but a different file put in place
+        QVERIFY(writeFile(path("a.next"), "ALPHA"));
+        QVERIFY(QFile::remove(path("a.txt")));
+        QVERIFY(QFile::rename(path("a.next"), path("a.txt")));
+    }
+
+    const FileEventBatch events = scan(&scanner);
+    if (!expectChanged) {
+        QVERIFY(events.isEmpty());
+        return;
+    }
+    QCOMPARE(events.size(), 1);
+    QCOMPARE(events.first().path, path("a.txt"));
+    QVERIFY(events.first().kind == FileEvent::Kind::Changed);
+    QCOMPARE(scanner.fileCount(), 2);
+}
+
+void TestPollingScanner::reportsInEventOrder()
+{
+    PollingScanner scanner(m_dir->path(), ExclusionMatcher());
+    QVERIFY(scan(&scanner).isEmpty());
+
+    QVERIFY(writeFile(path("a.txt"), "alphabet"));
+    QVERIFY(writeFile(path("sub/c.txt"), "gamma"));
+    QVERIFY(QFile::remove(path("sub/b.txt")));
+
+    // Deletions, then creations, then changes
+    const FileEventBatch events = scan(&scanner);
+    QCOMPARE(events.size(), 3);
+    QCOMPARE(events.at(0).path, path("sub/b.txt"));
+    QVERIFY(events.at(0).kind == FileEvent::Kind::Deleted);
+    QCOMPARE(events.at(1).path, path("sub/c.txt"));
+    QVERIFY(events.at(1).kind == FileEvent::Kind::Created);
+    QCOMPARE(events.at(2).path, path("a.txt"));
+    QVERIFY(events.at(2).kind == FileEvent::Kind::Changed);
+    QCOMPARE(scanner.fileCount(), 2);
+}
+
+void TestPollingScanner::renamePairedByInode()
+{
+#ifndef Q_OS_UNIX
+    QSKIP("Renames are paired by inode, which is only tracked on Unix");
+#endif
+    PollingScanner scanner(m_dir->path(), ExclusionMatcher());
+    QVERIFY(scan(&scanner).isEmpty());
+
+    QVERIFY(QFile::rename(path("a.txt"), path("sub/moved.txt")));
+
+    const FileEventBatch events = scan(&scanner);
+    QCOMPARE(events.size(), 1);
+    QVERIFY(events.first().kind == FileEvent::Kind::Renamed);
+    QCOMPARE(events.first().oldPath, path("a.txt"));
+    QCOMPARE(events.first().path, path("sub/moved.txt"));
+    QCOMPARE(scanner.fileCount(), 2);
+}
+
+void TestPollingScanner::renameWithChangedStampNotPaired()
+{
+    PollingScanner scanner(m_dir->path(), ExclusionMatcher());
+    QVERIFY(scan(&scanner).isEmpty());
+
+    // Moved and written before the next scan: the contents may differ too
+    QVERIFY(QFile::rename(path("a.txt"), path("moved.txt")));
+    QVERIFY(writeFile(path("moved.txt"), "alphabet"));
+
+    const FileEventBatch events = scan(&scanner);
+    QCOMPARE(events.size(), 2);
+    QCOMPARE(events.at(0).path, path("a.txt"));
+    QVERIFY(events.at(0).kind == FileEvent::Kind::Deleted);
+    QCOMPARE(events.at(1).path, path("moved.txt"));
+    QVERIFY(events.at(1).kind == FileEvent::Kind::Created);
+}
+
+void TestPollingScanner::newDirectory()
+{
+    PollingScanner scanner(m_dir->path(), ExclusionMatcher());
+    QVERIFY(scan(&scanner).isEmpty());
+
+    QVERIFY(QDir(m_dir->path()).mkpath("new/deep"));
+    QVERIFY(writeFile(path("new/deep/d.txt"), "delta"));
+
+    // Found by the root's listing and checked in the following waves
+    const FileEventBatch events = scan(&scanner);
+    QCOMPARE(events.size(), 1);
+    QCOMPARE(events.first().path, path("new/deep/d.txt"));
+    QVERIFY(events.first().kind == FileEvent::Kind::Created);
+    QCOMPARE(scanner.directoryCount(), 4);
+    QCOMPARE(scanner.fileCount(), 3);
+}
+
+void TestPollingScanner::removedDirectory()
+{
+    QVERIFY(writeFile(path("sub/c.txt"), "gamma"));
+    PollingScanner scanner(m_dir->path(), ExclusionMatcher());
+    QVERIFY(scan(&scanner).isEmpty());
+
+    QVERIFY(QDir(path("sub")).removeRecursively());
+
+    const FileEventBatch events = scan(&scanner);
+    QStringList deleted;
+    for (const FileEvent& event : events) {
+        QVERIFY(event.kind == FileEvent::Kind::Deleted);
+        deleted << event.path;
+    }
+    deleted.sort();
+    QCOMPARE(deleted, QStringList({path("sub/b.txt"), path("sub/c.txt")}));
+    QCOMPARE(scanner.directoryCount(), 1);
+    QCOMPARE(scanner.fileCount(), 1);
+}
+
+void TestPollingScanner::excludedPathsIgnored()
+{
+    const ExclusionMatcher exclusions(QStringList({"build"}), QStringList({"notes.txt"}));
+    PollingScanner scanner(m_dir->path(), exclusions);
+    QVERIFY(scan(&scanner).isEmpty());
+
+    QVERIFY(QDir(m_dir->path()).mkdir("build"));
+    QVERIFY(writeFile(path("build/out.o"), "object"));
+    QVERIFY(writeFile(path("notes.txt"), "notes"));
+    QVERIFY(writeFile(path("a.txt~"), "backup"));
+
+    QVERIFY(scan(&scanner).isEmpty());
+    QCOMPARE(scanner.directoryCount(), 2);
+    QCOMPARE(scanner.fileCount(), 2);
+}
+
+void TestPollingScanner::seedReportsChangesSinceManifest()
+{
+    const ExclusionMatcher exclusions;
+    const FileManifest manifest = FileManifest::scan(m_dir->path(), exclusions);
+    QCOMPARE(manifest.fileCount(), 2);
+
+    QVERIFY(writeFile(path("a.txt"), "alphabet"));
+
+    // Seeded, the first scan already reports what moved since the manifest
+    PollingScanner scanner(m_dir->path(), exclusions);
+    scanner.seed(manifest);
+    QCOMPARE(scanner.fileCount(), 2);
+    QCOMPARE(scanner.directoryCount(), 2);
+
+    const FileEventBatch events = scan(&scanner);
+    QCOMPARE(events.size(), 1);
+    QCOMPARE(events.first().path, path("a.txt"));
+    QVERIFY(events.first().kind == FileEvent::Kind::Changed);
+}
+
+QTEST_APPLESS_MAIN(TestPollingScanner)
+#include "tst_polling_scanner.moc"